@@ -0,0 +1,106 @@
+#!/usr/bin/env bash
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Library Public License as published by
+# the Free Software Foundation; either version 2, or (at your option)
+# any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Library Public License for more details.
+#
+
+source $CEPH_ROOT/qa/standalone/ceph-helpers.sh
+
+function run() {
+    local dir=$1
+    shift
+
+    export CEPH_MON="127.0.0.1:7148" # git grep '\<7148\>' : there must be only one
+    export CEPH_ARGS
+    CEPH_ARGS+="--fsid=$(uuidgen) --auth-supported=none "
+    CEPH_ARGS+="--mon-host=$CEPH_MON "
+
+    local funcs=${@:-$(set | sed -n -e 's/^\(TEST_[0-9a-z_]*\) .*/\1/p')}
+    for func in $funcs ; do
+        setup $dir || return 1
+        run_mon $dir a || return 1
+        run_mgr $dir x || return 1
+        for id in 0 1 2 ; do
+            run_osd_bluestore $dir $id --osd_ec_partial_reads=true || return 1
+        done
+        create_ec_pool ecpool || return 1
+
+        $func $dir || return 1
+        teardown $dir || return 1
+    done
+}
+
+function create_ec_pool() {
+    local poolname=$1
+
+    ceph osd erasure-code-profile set myprofile \
+        plugin=jerasure k=2 m=1 stripe_unit=4K \
+        crush-failure-domain=osd || return 1
+    create_pool $poolname 1 1 erasure myprofile || return 1
+    # unaligned reads are only left unaligned by rados on pools that do
+    # not require aligned io
+    ceph osd pool set $poolname allow_ec_overwrites true || return 1
+    wait_for_clean || return 1
+}
+
+function TEST_ec_partial_read() {
+    local dir=$1
+
+    dd if=/dev/urandom of=$dir/ORIGINAL bs=65536 count=1 2>/dev/null
+    truncate --size=70000 $dir/ORIGINAL
+    rados --pool ecpool put obj $dir/ORIGINAL || return 1
+
+    # 4K reads each cover a single data chunk of the 8K stripes, other
+    # sizes straddle chunks, stripes and the end of the object
+    for bs in 4096 3000 6000 12288 ; do
+        rados --pool ecpool get -b $bs obj $dir/COPY || return 1
+        cmp $dir/ORIGINAL $dir/COPY || return 1
+        rm $dir/COPY
+    done
+}
+
+function TEST_ec_read_hedge() {
+    local dir=$1
+
+    dd if=/dev/urandom of=$dir/ORIGINAL bs=65536 count=1 2>/dev/null
+    rados --pool ecpool put obj $dir/ORIGINAL || return 1
+
+    local osds=($(get_osds ecpool obj))
+    local primary=${osds[0]}
+    local slow=${osds[1]}
+
+    # the second data shard answers after 10s, the hedge to the coding
+    # shard must complete the read long before that
+    ceph tell osd.$primary injectargs -- --osd_ec_read_hedge_delay=0.5 || return 1
+    ceph tell osd.$slow injectargs -- \
+        --osd_debug_inject_dispatch_delay_probability=1 \
+        --osd_debug_inject_dispatch_delay_duration=10 || return 1
+    timeout 8 rados --pool ecpool get obj $dir/COPY || return 1
+    cmp $dir/ORIGINAL $dir/COPY || return 1
+    ceph tell osd.$slow injectargs -- \
+        --osd_debug_inject_dispatch_delay_probability=0 || return 1
+
+    CEPH_ARGS='' ceph --admin-daemon $(get_asok_path osd.$primary) log flush || return 1
+    grep -q 'hedge_read_op: hedging' $dir/osd.$primary.log || return 1
+
+    # reads finishing well within the delay are never hedged
+    ceph tell osd.$primary injectargs -- --osd_ec_read_hedge_delay=30 || return 1
+    local hedged=$(grep -c 'hedge_read_op: hedging' $dir/osd.$primary.log)
+    rados --pool ecpool get obj $dir/COPY || return 1
+    cmp $dir/ORIGINAL $dir/COPY || return 1
+    CEPH_ARGS='' ceph --admin-daemon $(get_asok_path osd.$primary) log flush || return 1
+    test $(grep -c 'hedge_read_op: hedging' $dir/osd.$primary.log) = $hedged || return 1
+}
+
+main test-erasure-read "$@"
+
+# Local Variables:
+# compile-command: "cd ../../../build ; make -j4 && ../qa/run-standalone.sh test-erasure-read.sh"
+# End:
@@ -0,0 +1,109 @@
+#!/usr/bin/env bash
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Library Public License as published by
+# the Free Software Foundation; either version 2, or (at your option)
+# any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Library Public License for more details.
+#
+
+source $CEPH_ROOT/qa/standalone/ceph-helpers.sh
+
+function run() {
+    local dir=$1
+    shift
+
+    export CEPH_MON="127.0.0.1:7147" # git grep '\<7147\>' : there must be only one
+    export CEPH_ARGS
+    CEPH_ARGS+="--fsid=$(uuidgen) --auth-supported=none "
+    CEPH_ARGS+="--mon-host=$CEPH_MON "
+
+    local funcs=${@:-$(set | sed -n -e 's/^\(TEST_[0-9a-z_]*\) .*/\1/p')}
+    for func in $funcs ; do
+        setup $dir || return 1
+        run_mon $dir a || return 1
+        run_mgr $dir x || return 1
+        for id in 0 1 2 ; do
+            run_osd $dir $id --osd_async_read_threads=2 || return 1
+        done
+        create_pool foo 1 1 || return 1
+        wait_for_clean || return 1
+
+        $func $dir || return 1
+        teardown $dir || return 1
+    done
+}
+
+function TEST_async_read() {
+    local dir=$1
+
+    # objects from a few bytes to several stripes of the default read size
+    for size in 1 4095 4096 65537 1048576 4194304 ; do
+        dd if=/dev/urandom of=$dir/ORIGINAL.$size bs=$size count=1 2>/dev/null
+        rados --pool foo put obj-$size $dir/ORIGINAL.$size || return 1
+    done
+    for size in 1 4095 4096 65537 1048576 4194304 ; do
+        rados --pool foo get obj-$size $dir/COPY || return 1
+        cmp $dir/ORIGINAL.$size $dir/COPY || return 1
+        rm $dir/COPY
+    done
+
+    # several objects read at once share the read threads
+    for size in 65537 1048576 4194304 ; do
+        rados --pool foo get obj-$size $dir/COPY.$size &
+    done
+    wait
+    for size in 65537 1048576 4194304 ; do
+        cmp $dir/ORIGINAL.$size $dir/COPY.$size || return 1
+    done
+}
+
+function TEST_async_sparse_read() {
+    local dir=$1
+
+    # rbd reads whole objects with sparse reads; leave holes between
+    # and after the written extents
+    rbd pool init foo || return 1
+    truncate --size=4194304 $dir/ORIGINAL
+    for off in 0 17 40 ; do
+        dd if=/dev/urandom of=$dir/ORIGINAL bs=65536 count=1 seek=$off \
+            conv=notrunc 2>/dev/null
+    done
+    rbd import --pool foo $dir/ORIGINAL img || return 1
+    rbd export --pool foo img $dir/COPY || return 1
+    cmp $dir/ORIGINAL $dir/COPY || return 1
+}
+
+function TEST_async_read_after_on_change() {
+    local dir=$1
+
+    dd if=/dev/urandom of=$dir/ORIGINAL bs=65536 count=4 2>/dev/null
+    rados --pool foo put obj $dir/ORIGINAL || return 1
+    local primary=$(get_primary foo obj)
+
+    # hold the read on the read threads while the pg changes interval;
+    # its completion must be dropped and the op redone
+    ceph tell osd.$primary injectargs -- --osd_debug_async_read_delay=5 || return 1
+    timeout 120 rados --pool foo get obj $dir/COPY &
+    local pid=$!
+    sleep 2
+    ceph osd down osd.$primary || return 1
+    ceph tell osd.$primary injectargs -- --osd_debug_async_read_delay=0 || return 1
+    wait $pid || return 1
+    cmp $dir/ORIGINAL $dir/COPY || return 1
+
+    wait_for_clean || return 1
+    kill -0 $(cat $dir/osd.$primary.pid) || return 1
+    rados --pool foo get obj $dir/COPY || return 1
+    cmp $dir/ORIGINAL $dir/COPY || return 1
+}
+
+main osd-async-read "$@"
+
+# Local Variables:
+# compile-command: "cd ../../../build ; make -j4 && ../qa/run-standalone.sh osd-async-read.sh"
+# End:
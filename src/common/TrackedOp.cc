@@ -243,6 +243,8 @@ bool OpTracker::dump_ops_in_flight(Formatter *f, bool print_only_blocked, set<st
     f->dump_int("num_blocked_ops", total_ops_in_flight);
   } else
     f->dump_int("num_ops", total_ops_in_flight);
+  f->dump_unsigned("sample_rate", sample_rate);
+  f->dump_unsigned("total_ops_tracked", seq);
   f->close_section(); // overall dump
   return true;
 }
@@ -252,8 +254,13 @@ bool OpTracker::register_inflight_op(TrackedOp *i)
   if (!tracking_enabled)
     return false;
 
-  RWLock::RLocker l(lock);
+  // every op is registered so that slow ones are always seen, but only
+  // sampled ones record their events
   uint64_t current_seq = ++seq;
+  uint32_t rate = sample_rate;
+  i->sampled = rate <= 1 || current_seq % rate == 0;
+  if (i->sampled)
+    i->events.reset(new TrackedOp::EventSlot[OPTRACKER_EVENT_RING_SIZE]);
   uint32_t shard_index = current_seq % num_optracker_shards;
   ShardedTrackingData* sdata = sharded_in_flight_list[shard_index];
   assert(NULL != sdata);
@@ -282,8 +289,10 @@ void OpTracker::unregister_inflight_op(TrackedOp *i)
 
   if (!tracking_enabled)
     delete i;
+  else if (!i->sampled &&
+	   i->get_duration() < history.get_slow_op_threshold())
+    delete i;
   else {
-    RWLock::RLocker l(lock);
     i->state = TrackedOp::STATE_HISTORY;
     utime_t now = ceph_clock_now();
     history.insert(now, TrackedOpRef(i));
@@ -387,10 +396,11 @@ bool OpTracker::check_ops_in_flight(std::string* summary,
   auto warn_on_slow_op = [&](TrackedOp& op) {
     stringstream ss;
     utime_t age = now - op.get_initiated();
+    string current = op.get_current();
     ss << "slow request " << age << " seconds old, received at "
        << op.get_initiated() << ": " << op.get_desc()
        << " currently "
-        << (op.current ? op.current : op.state_string());
+        << (current.empty() ? op.state_string() : current);
     warnings.push_back(ss.str());
     // only those that have been shown will backoff
     op.warn_interval_multiplier *= 2;
@@ -433,16 +443,66 @@ void OpTracker::get_age_ms_histogram(pow2_hist_t *h)
 #undef dout_context
 #define dout_context tracker->cct
 
+void TrackedOp::_record_event(const Event& e)
+{
+  uint64_t n = num_events++;
+  EventSlot& slot = events[n % OPTRACKER_EVENT_RING_SIZE];
+  std::lock_guard<ceph::spinlock> l(slot.lock);
+  // a slower writer of an older event must not clobber a newer one
+  if (slot.n > n)
+    return;
+  slot.n = n + 1;
+  slot.event = e;
+}
+
+void TrackedOp::get_events(vector<Event> *ls) const
+{
+  if (!events)
+    return;
+  uint64_t n = num_events;
+  uint64_t first = n > OPTRACKER_EVENT_RING_SIZE ?
+    n - OPTRACKER_EVENT_RING_SIZE : 0;
+  ls->reserve(n - first);
+  for (uint64_t i = first; i < n; ++i) {
+    const EventSlot& slot = events[i % OPTRACKER_EVENT_RING_SIZE];
+    std::lock_guard<ceph::spinlock> l(slot.lock);
+    if (slot.n != i + 1)
+      continue;  // not yet written, or already overwritten
+    ls->push_back(slot.event);
+  }
+}
+
+string TrackedOp::get_current() const
+{
+  std::lock_guard<ceph::spinlock> l(current_lock);
+  return current.c_str();
+}
+
+void TrackedOp::dump_events(Formatter *f) const
+{
+  vector<Event> ls;
+  get_events(&ls);
+  f->open_array_section("events");
+  for (auto& i : ls) {
+    f->dump_object("event", i);
+  }
+  f->close_section();
+}
+
 void TrackedOp::mark_event_string(const string &event, utime_t stamp)
 {
   if (!state)
     return;
 
+  // keep the current state even for unsampled ops, for slow op warnings
+  Event e(stamp, event);
   {
-    Mutex::Locker l(lock);
-    events.emplace_back(stamp, event);
-    current = events.back().c_str();
+    std::lock_guard<ceph::spinlock> l(current_lock);
+    current = e;
   }
+  if (!sampled)
+    return;
+  _record_event(e);
   dout(6) << " seq: " << seq
 	  << ", time: " << stamp
 	  << ", event: " << event
@@ -456,11 +516,15 @@ void TrackedOp::mark_event(const char *event, utime_t stamp)
   if (!state)
     return;
 
+  // keep the current state even for unsampled ops, for slow op warnings
+  Event e(stamp, event);
   {
-    Mutex::Locker l(lock);
-    events.emplace_back(stamp, event);
-    current = event;
+    std::lock_guard<ceph::spinlock> l(current_lock);
+    current = e;
   }
+  if (!sampled)
+    return;
+  _record_event(e);
   dout(6) << " seq: " << seq
 	  << ", time: " << stamp
 	  << ", event: " << event
@@ -19,7 +19,8 @@
 #include "msg/Message.h"
 #include "common/RWLock.h"
 
-#define OPTRACKER_PREALLOC_EVENTS 20
+// number of most recent events kept per op; must be a power of two
+#define OPTRACKER_EVENT_RING_SIZE 32
 
 class TrackedOp;
 class OpHistory;
@@ -95,6 +96,9 @@ public:
     history_slow_op_size = new_size;
     history_slow_op_threshold = new_threshold;
   }
+  uint32_t get_slow_op_threshold() const {
+    return history_slow_op_threshold;
+  }
 };
 
 struct ShardedTrackingData;
@@ -107,6 +111,7 @@ class OpTracker {
   float complaint_time;
   int log_threshold;
   std::atomic<bool> tracking_enabled;
+  std::atomic<uint32_t> sample_rate = { 1 };
   RWLock       lock;
 
 public:
@@ -129,6 +134,19 @@ public:
   void set_tracking(bool enable) {
     tracking_enabled = enable;
   }
+  /**
+   * record events and history for only 1 in every rate ops
+   *
+   * All ops are still registered in flight, so slow ops are counted
+   * and warned about, and unsampled ops that turn out to be slow are
+   * still kept in the slow op history.  1 samples every op.
+   */
+  void set_sample_rate(uint32_t rate) {
+    sample_rate = std::max<uint32_t>(rate, 1);
+  }
+  uint32_t get_sample_rate() const {
+    return sample_rate;
+  }
   bool dump_ops_in_flight(Formatter *f, bool print_only_blocked = false, set<string> filters = {""});
   bool dump_historic_ops(Formatter *f, bool by_duration = false, set<string> filters = {""});
   bool dump_historic_slow_ops(Formatter *f, set<string> filters = {""});
@@ -227,24 +245,37 @@ protected:
 
   struct Event {
     utime_t stamp;
-    string str;
-    const char *cstr = nullptr;
+    const char *cstr = nullptr;  ///< static event name, or null to use str
+    char str[40];                ///< copy of a short dynamic name
+    string long_str;             ///< a dynamic name too long for str
 
-    Event(utime_t t, const string& s) : stamp(t), str(s) {}
-    Event(utime_t t, const char *s) : stamp(t), cstr(s) {}
+    Event() {
+      str[0] = '\0';
+    }
+    Event(utime_t t, const char *s) : stamp(t), cstr(s) {
+      str[0] = '\0';
+    }
+    Event(utime_t t, const string& s) : stamp(t) {
+      if (s.size() < sizeof(str)) {
+	memcpy(str, s.data(), s.size());
+	str[s.size()] = '\0';
+      } else {
+	str[0] = '\0';
+	long_str = s;
+      }
+    }
 
     int compare(const char *s) const {
-      if (cstr)
-	return strcmp(cstr, s);
-      else
-	return str.compare(s);
+      return strcmp(c_str(), s);
     }
 
     const char *c_str() const {
       if (cstr)
 	return cstr;
+      else if (!long_str.empty())
+	return long_str.c_str();
       else
-	return str.c_str();
+	return str;
     }
 
     void dump(Formatter *f) const {
@@ -253,10 +284,28 @@ protected:
     }
   };
 
-  vector<Event> events;    ///< list of events and their times
-  mutable Mutex lock = {"TrackedOp::lock"}; ///< to protect the events list
-  const char *current = 0; ///< the current state the event is in
+  /*
+   * sampled ops keep their events in a fixed ring, allocated when the op
+   * is registered, so that marking one takes no lock shared with other
+   * events of the op.  Each slot has its own spinlock and remembers which
+   * event it holds; readers skip slots that have been overwritten.
+   */
+  struct EventSlot {
+    mutable ceph::spinlock lock;
+    uint64_t n = 0;  ///< index + 1 of the event held, 0 if none
+    Event event;
+  };
+  std::unique_ptr<EventSlot[]> events;     ///< null unless sampled
+  std::atomic<uint64_t> num_events = {0};  ///< events ever marked
+
+  mutable Mutex lock = {"TrackedOp::lock"}; ///< to protect desc_str
+  mutable ceph::spinlock current_lock;     ///< to protect current
+  Event current;           ///< the latest event, kept even if unsampled
   uint64_t seq = 0;        ///< a unique value set by the OpTracker
+  bool sampled = true;     ///< record events and history for this op
+
+  utime_t done_at;         ///< valid once done is set
+  std::atomic<bool> done = {false};
 
   uint32_t warn_interval_multiplier = 1; //< limits output of a given op warning
 
@@ -275,9 +324,15 @@ protected:
     tracker(_tracker),
     initiated_at(initiated)
   {
-    events.reserve(OPTRACKER_PREALLOC_EVENTS);
   }
 
+  /// store an event in the ring of a sampled op
+  void _record_event(const Event& e);
+  /// copy out the events still in the ring, oldest first
+  void get_events(vector<Event> *ls) const;
+  /// dump the events still in the ring as an "events" array
+  void dump_events(Formatter *f) const;
+
   /// output any type-specific data you want to get when dump() is called
   virtual void _dump(Formatter *f) const {}
   /// if you want something else to happen when events are marked, implement
@@ -309,7 +364,9 @@ public:
 	break;
 
       case STATE_LIVE:
-	mark_event("done");
+	done_at = ceph_clock_now();
+	done = true;
+	mark_event("done", done_at);
 	tracker->unregister_inflight_op(this);
 	break;
 
@@ -348,28 +405,35 @@ public:
   }
 
   double get_duration() const {
-    Mutex::Locker l(lock);
-    if (!events.empty() && events.rbegin()->compare("done") == 0)
-      return events.rbegin()->stamp - get_initiated();
+    if (done)
+      return done_at - get_initiated();
     else
       return ceph_clock_now() - get_initiated();
   }
 
+  bool is_sampled() const {
+    return sampled;
+  }
+
   void mark_event_string(const string &event,
 			 utime_t stamp=ceph_clock_now());
   void mark_event(const char *event,
 		  utime_t stamp=ceph_clock_now());
 
-  virtual const char *state_string() const {
-    Mutex::Locker l(lock);
-    return events.rbegin()->c_str();
+  /// the latest event marked, empty if none
+  string get_current() const;
+
+  virtual string state_string() const {
+    string s = get_current();
+    return s.empty() ? "initiated" : s;
   }
 
   void dump(utime_t now, Formatter *f) const;
 
   void tracking_start() {
     if (tracker->register_inflight_op(this)) {
-      events.emplace_back(initiated_at, "initiated");
+      if (sampled)
+	_record_event(Event(initiated_at, "initiated"));
       state = STATE_LIVE;
     }
   }
@@ -41,6 +41,9 @@ using namespace ceph;
 
 #define CEPH_BUFFER_ALLOC_UNIT  (std::min(CEPH_PAGE_SIZE, 4096u))
 #define CEPH_BUFFER_APPEND_SIZE (CEPH_BUFFER_ALLOC_UNIT - sizeof(raw_combined))
+// claim_append() copies lists up to this size into the append_buffer
+// instead of linking their segments
+#define CEPH_BUFFER_COALESCE_SIZE 128
 
 #ifdef BUFFER_DEBUG
 # define bdout { std::lock_guard<ceph::spinlock> lg(ceph::spinlock()); std::cout
@@ -1120,6 +1123,11 @@ public:
         _raw->invalidate_crc();
     memset(c_str()+o, 0, l);
   }
+  void buffer::ptr::set_crc32c(uint32_t base, uint32_t crc) const
+  {
+    assert(_raw);
+    _raw->set_crc(make_pair(_off, _off + _len), make_pair(base, crc));
+  }
   bool buffer::ptr::can_zero_copy() const
   {
     return _raw->can_zero_copy();
@@ -1830,6 +1838,21 @@ public:
 
   void buffer::list::claim_append(list& bl, unsigned int flags)
   {
+    if (bl._len > 0 &&
+	bl._len <= CEPH_BUFFER_COALESCE_SIZE &&
+	append_buffer.have_raw() &&
+	append_buffer.unused_tail_length() >= bl._len) {
+      // a few bytes onto a list that is being encoded into, and they fit
+      // in what is left of its append_buffer: copying them is cheaper
+      // than carrying their segments (and raws) around for the life of
+      // this list
+      for (auto& p : bl._buffers)
+	append(p.c_str(), p.length());
+      bl._buffers.clear();
+      bl._len = 0;
+      bl.last_p = bl.begin();
+      return;
+    }
     // steal the other guy's buffers
     _len += bl._len;
     if (!(flags & CLAIM_ALLOW_NONSHAREABLE))
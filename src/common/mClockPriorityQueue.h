@@ -310,6 +310,13 @@ namespace ceph {
       queue.add_request(std::move(item), cl, cost);
     }
 
+    // enqueue with the delta/rho the client tracked for this server
+    void enqueue_distributed(K cl, unsigned priority, unsigned cost, T&& item,
+			     const dmc::ReqParams& req_params) {
+      // priority is ignored
+      queue.add_request(std::move(item), cl, req_params, cost);
+    }
+
     void enqueue_front(K cl,
 		       unsigned priority,
 		       unsigned cost,
@@ -322,7 +329,16 @@ namespace ceph {
     }
 
     T dequeue() override final {
+      return dequeue_distributed(nullptr);
+    }
+
+    // dequeue and report the phase the item was scheduled in; items
+    // that bypass the dmclock queue count as priority
+    T dequeue_distributed(dmc::PhaseType *phase) {
       assert(!empty());
+      if (phase) {
+	*phase = dmc::PhaseType::priority;
+      }
 
       if (!high_queue.empty()) {
 	T ret = std::move(high_queue.rbegin()->second.front().second);
@@ -342,6 +358,9 @@ namespace ceph {
       auto pr = queue.pull_request();
       assert(pr.is_retn());
       auto& retn = pr.get_retn();
+      if (phase) {
+	*phase = retn.phase;
+      }
       return std::move(*(retn.request));
     }
 
@@ -892,6 +892,12 @@ std::vector<Option> get_global_options() {
     .set_default(100_M)
     .set_description(""),
 
+    Option("ms_dispatch_lanes", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(false)
+    .set_flag(Option::FLAG_STARTUP)
+    .set_description("Dispatch messages from each type of peer in its own thread")
+    .set_long_description("Messages that are not fast dispatched are queued by the type of their sender (mon, mgr, osd, mds, client) and each queue gets its own dispatch thread, so a flood of messages from one type of peer does not delay the others.  Messages from one connection are still delivered in order, but dispatchers must tolerate ms_dispatch calls from several threads at once."),
+
     Option("ms_bind_ipv6", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
     .set_default(false)
     .set_description(""),
@@ -984,6 +990,36 @@ std::vector<Option> get_global_options() {
     .set_min_max(1, 24)
     .set_description(""),
 
+    Option("ms_compress_peer_types", Option::TYPE_STR, Option::LEVEL_ADVANCED)
+    .set_default("")
+    .set_description("Peer types to compress messages to (e.g. \"osd client\")")
+    .set_long_description("Messages of at least ms_compress_min_size bytes sent to peers of these types are compressed with ms_compress_algorithm, if the peer supports it.  Useful when replication or client traffic crosses a slow link.  Empty disables compression; received compressed messages are always accepted.  Read when a messenger is created.")
+    .add_see_also("ms_compress_algorithm")
+    .add_see_also("ms_compress_min_size"),
+
+    Option("ms_compress_algorithm", Option::TYPE_STR, Option::LEVEL_ADVANCED)
+    .set_default("snappy")
+    .set_enum_allowed({"snappy", "zlib", "zstd", "lz4"})
+    .set_description("Compression algorithm for messenger traffic")
+    .add_see_also("ms_compress_peer_types"),
+
+    Option("ms_compress_min_size", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(8192)
+    .set_description("Only compress messages whose payload is at least this many bytes")
+    .add_see_also("ms_compress_peer_types"),
+
+    Option("ms_async_rx_buffer_pool_bytes", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(0)
+    .set_flag(Option::FLAG_STARTUP)
+    .set_description("Bytes of freed message data buffers each messenger worker keeps for reuse")
+    .set_long_description("Incoming message data is read into page aligned buffers that follow the sender's data_off alignment hint.  Freed buffers return to a per-worker pool of up to this many bytes, saving the page aligned allocation on the next message.  That memory stays allocated in every worker, so the pool is off (0) by default."),
+
+    Option("ms_async_zerocopy_min_bytes", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(0)
+    .set_description("Send with MSG_ZEROCOPY when at least this many bytes are queued on a connection")
+    .set_long_description("The posix stack then lets the kernel send from the message buffers instead of copying them, keeping them referenced until the kernel reports completion. Applies to new connections; 0 disables. Needs Linux 4.14 or newer, and sockets fall back to plain sends where the kernel copies anyway, such as loopback.")
+    .add_see_also("ms_type"),
+
     Option("ms_async_max_op_threads", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
     .set_default(5)
     .set_description(""),
@@ -1012,6 +1048,19 @@ std::vector<Option> get_global_options() {
     .set_default(1_K)
     .set_description(""),
 
+    Option("ms_async_rdma_send_buffers_max", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(0)
+    .set_flag(Option::FLAG_STARTUP)
+    .set_description("Grow the registered send buffers up to this many when they run out")
+    .set_long_description("ms_async_rdma_send_buffers are registered at startup; when senders run short, another region of that many is registered, up to this total.  Values below ms_async_rdma_send_buffers keep the pool fixed.")
+    .add_see_also("ms_async_rdma_send_buffers"),
+
+    Option("ms_async_rdma_inline_size", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(0)
+    .set_flag(Option::FLAG_STARTUP)
+    .set_description("Send chunks up to this many bytes inline in the work request")
+    .set_long_description("Saves the HCA a DMA read of the send buffer, cutting latency for small messages.  Queue pairs are created without inline sends if the device cannot take this size; 0 disables."),
+
     Option("ms_async_rdma_receive_buffers", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
     .set_default(32768)
     .set_description(""),
@@ -1901,6 +1950,12 @@ std::vector<Option> get_global_options() {
     .set_default(false)
     .set_description(""),
 
+    Option("objecter_mclock_service_tracker", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(false)
+    .set_description("Track dmclock delta/rho per OSD and send them with each op")
+    .set_long_description("Lets OSDs running osd_op_queue=mclock_client enforce a client's reservation and limit across all of the OSDs it talks to rather than per OSD. Only enable once every OSD understands the v9 osd_op encoding.")
+    .add_see_also("osd_op_queue"),
+
     Option("objecter_debug_inject_relock_delay", Option::TYPE_BOOL, Option::LEVEL_DEV)
     .set_default(false)
     .set_description(""),
@@ -2200,7 +2255,7 @@ std::vector<Option> get_global_options() {
 
     Option("osd_tier_default_cache_hit_set_type", Option::TYPE_STR, Option::LEVEL_ADVANCED)
     .set_default("bloom")
-    .set_enum_allowed({"bloom", "explicit_hash", "explicit_object"})
+    .set_enum_allowed({"bloom", "explicit_hash", "explicit_object", "count_min"})
     .set_flag(Option::FLAG_RUNTIME)
     .set_description(""),
 
@@ -2241,6 +2296,11 @@ std::vector<Option> get_global_options() {
     .set_default(40)
     .set_description(""),
 
+    Option("osd_advance_pg_reuse_mapping", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(true)
+    .set_description("Reuse a PG's up/acting mapping while advancing across epochs that cannot change it")
+    .set_long_description("When a PG catches up on several OSDMap epochs, epochs whose incrementals only carry changes that cannot remap it (up_thru, pg_temp for other PGs, blacklist and so on) reuse the previously calculated mapping instead of running CRUSH again."),
+
     Option("osd_pg_epoch_max_lag_factor", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
     .set_default(2.0)
     .set_description("Max multiple of the map cache that PGs can lag before we throttle map injest")
@@ -2274,6 +2334,17 @@ std::vector<Option> get_global_options() {
     .set_default(1)
     .set_description(""),
 
+    Option("osd_async_read_threads", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(0)
+    .set_flag(Option::FLAG_STARTUP)
+    .set_description("Threads that read replicated pool objects for client ops")
+    .set_long_description("With a nonzero value, plain client reads on replicated pools are issued to these threads instead of blocking the op shard while the object store reads; the op resumes once its reads are back, the way erasure coded pool reads do.  0 reads synchronously on the op thread."),
+
+    Option("osd_debug_async_read_delay", Option::TYPE_FLOAT, Option::LEVEL_DEV)
+    .set_default(0)
+    .set_description("Seconds each async read thread waits before reading")
+    .add_see_also("osd_async_read_threads"),
+
     Option("osd_recover_clone_overlap", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
     .set_default(true)
     .set_description(""),
@@ -2791,10 +2862,33 @@ std::vector<Option> get_global_options() {
     .set_default(false)
     .set_description(""),
 
+    Option("osd_ec_partial_reads", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(false)
+    .set_description("Read only the data shards covering the requested extent")
+    .set_long_description("When a client read of an erasure coded object lies within fewer than all of the data chunks of a stripe, read just the shards holding those chunks instead of every data shard."),
+
+    Option("osd_ec_read_hedge_delay", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
+    .set_default(0)
+    .set_description("Time in seconds after which a slow erasure coded read is hedged, 0 to disable")
+    .set_long_description("If a client read of an erasure coded object is still waiting on a shard after this many seconds, the read is also sent to the remaining shards and completes with whichever decodable set replies first.")
+    .add_see_also("osd_ec_partial_reads"),
+
     Option("osd_recover_clone_overlap_limit", Option::TYPE_INT, Option::LEVEL_ADVANCED)
     .set_default(10)
     .set_description(""),
 
+    Option("osd_recover_modified_extents", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(false)
+    .set_description("Record modified extents in pg log entries and push only those extents when recovering a replica")
+    .set_long_description("When a replica's copy of an object is only missing updates that are all still in the pg log and whose extents were recorded, recovery pushes just the modified extents and the replica reuses the rest of its local copy. Delta pushes are only made while every peer of the PG is running nautilus or later.")
+    .add_see_also("osd_recover_modified_extents_max_intervals"),
+
+    Option("osd_recover_modified_extents_max_intervals", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(16)
+    .set_description("Maximum number of extents recorded per pg log entry")
+    .set_long_description("Writes touching more distinct extents than this are logged without extents, and recovery of the object falls back to pushing it whole.")
+    .add_see_also("osd_recover_modified_extents"),
+
     Option("osd_backfill_scan_min", Option::TYPE_INT, Option::LEVEL_ADVANCED)
     .set_default(64)
     .set_description(""),
@@ -2827,6 +2921,28 @@ std::vector<Option> get_global_options() {
     .set_default(0.025)
     .set_description("Time in seconds to sleep before next recovery or backfill op when data is on HDD and journal is on SSD"),
 
+    Option("osd_recovery_controller_target_latency", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
+    .set_default(0)
+    .set_description("Client op p99 latency (seconds) the recovery controller tries to hold; 0 disables it")
+    .set_long_description("When set, recovery concurrency and recovery sleep are adjusted every tick from the p99 latency of client ops instead of being taken from osd_recovery_max_active and osd_recovery_sleep*.")
+    .add_see_also("osd_recovery_max_active")
+    .add_see_also("osd_recovery_sleep"),
+
+    Option("osd_recovery_controller_max_active", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(10)
+    .set_description("Most recovery ops the recovery controller allows in flight")
+    .add_see_also("osd_recovery_controller_target_latency"),
+
+    Option("osd_recovery_controller_max_sleep", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
+    .set_default(0.5)
+    .set_description("Longest recovery sleep (seconds) the recovery controller uses")
+    .add_see_also("osd_recovery_controller_target_latency"),
+
+    Option("osd_recovery_controller_min_samples", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(20)
+    .set_description("Client ops needed in a tick before their latency throttles recovery")
+    .add_see_also("osd_recovery_controller_target_latency"),
+
     Option("osd_snap_trim_sleep", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
     .set_default(0)
     .set_description(""),
@@ -2864,6 +2980,18 @@ std::vector<Option> get_global_options() {
     .set_default(20)
     .set_description(""),
 
+    Option("osd_heartbeat_interval_max", Option::TYPE_FLOAT, Option::LEVEL_ADVANCED)
+    .set_default(0)
+    .set_description("Longest interval (in seconds) between peer pings while round trip times are steady")
+    .set_long_description("When larger than osd_heartbeat_interval, the ping interval stretches toward this value as the measured ping round trip deviation shrinks relative to its mean, and returns to osd_heartbeat_interval as it grows. It is capped at a third of osd_heartbeat_grace; the grace period itself is not changed.")
+    .add_see_also("osd_heartbeat_interval"),
+
+    Option("osd_heartbeat_use_data_traffic", Option::TYPE_BOOL, Option::LEVEL_ADVANCED)
+    .set_default(false)
+    .set_description("Treat replication replies from a peer as back-side heartbeat replies")
+    .set_long_description("Peers that sent a replication, EC or recovery reply within the last osd_heartbeat_interval are not pinged on the back network. Front pings are always sent, and a peer that stops replying is failed after osd_heartbeat_grace as before.")
+    .add_see_also("osd_heartbeat_interval"),
+
     Option("osd_heartbeat_min_peers", Option::TYPE_INT, Option::LEVEL_ADVANCED)
     .set_default(10)
     .set_description(""),
@@ -3290,6 +3418,14 @@ std::vector<Option> get_global_options() {
     .set_default(32)
     .set_description(""),
 
+    Option("osd_op_tracker_sample_rate", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
+    .set_default(1)
+    .set_min(1)
+    .set_flag(Option::FLAG_RUNTIME)
+    .set_description("Record events and op history for only 1 in this many ops")
+    .set_long_description("All ops are still tracked in flight, so slow ops are still counted and reported and are kept in the slow op history, but the event timeline and the regular op history are only kept for a sample of ops. 1 records every op.")
+    .add_see_also("osd_enable_op_tracker"),
+
     Option("osd_op_history_size", Option::TYPE_UINT, Option::LEVEL_ADVANCED)
     .set_default(20)
     .set_description(""),
@@ -350,6 +350,9 @@ namespace buffer CEPH_BUFFER_API {
     void zero(unsigned o, unsigned l);
     void zero(unsigned o, unsigned l, bool crc_reset);
 
+    /// note that crc32c(base) over this ptr is crc, for list::crc32c()
+    /// to reuse; for callers that checksum data as they fill it in
+    void set_crc32c(uint32_t base, uint32_t crc) const;
   };
 
 
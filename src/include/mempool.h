@@ -158,6 +158,7 @@ namespace mempool {
   f(bluefs)			      \
   f(buffer_anon)		      \
   f(buffer_meta)		      \
+  f(msgr)			      \
   f(osd)			      \
   f(osd_mapbl)			      \
   f(osd_pglog)			      \
@@ -435,6 +436,12 @@ public:
     using unordered_map =						\
       std::unordered_map<k,v,h,eq,pool_allocator<std::pair<const k,v>>>;\
                                                                         \
+    template<typename k, typename v,					\
+	     typename h=std::hash<k>,					\
+	     typename eq = std::equal_to<k>>				\
+    using unordered_multimap =						\
+      std::unordered_multimap<k,v,h,eq,pool_allocator<std::pair<const k,v>>>;\
+                                                                        \
     inline size_t allocated_bytes() {					\
       return mempool::get_pool(id).allocated_bytes();			\
     }									\
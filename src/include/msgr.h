@@ -164,6 +164,10 @@ struct ceph_msg_header {
 	__le32 crc;       /* header crc32c */
 } __attribute__ ((packed));
 
+/* ceph_msg_header.reserved flags */
+#define CEPH_MSG_HEADER_COMPRESSED  1  /* front, middle and data travel
+					  compressed in the data segment */
+
 #define CEPH_MSG_PRIO_LOW     64
 #define CEPH_MSG_PRIO_DEFAULT 127
 #define CEPH_MSG_PRIO_HIGH    196
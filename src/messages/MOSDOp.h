@@ -19,8 +19,13 @@
 #include "MOSDFastDispatchOp.h"
 #include "include/ceph_features.h"
 #include "common/hobject.h"
+#include "dmclock/src/dmclock_recs.h"
 #include <atomic>
 
+// the following is done to unclobber _ASSERT_H so it returns to the
+// way ceph likes it
+#include "include/assert.h"
+
 /*
  * OSD op
  *
@@ -33,7 +38,7 @@ class OSD;
 
 class MOSDOp : public MOSDFastDispatchOp {
 
-  static const int HEAD_VERSION = 8;
+  static const int HEAD_VERSION = 9;
   static const int COMPAT_VERSION = 3;
 
 private:
@@ -53,6 +58,8 @@ private:
   atomic<bool> final_decode_needed;
   //
 public:
+  MEMPOOL_CLASS_HELPERS();
+
   vector<OSDOp> ops;
 private:
   snapid_t snap_seq;
@@ -61,6 +68,12 @@ private:
   uint64_t features;
   bool bdata_encode;
   osd_reqid_t reqid; // reqid explicitly set by sender
+  // dmclock delta/rho from the client's service tracker; only sent
+  // (as v9) when the client tracks them
+  bool has_qos_params = false;
+  crimson::dmclock::ReqParams qos_params;
+  // phase the op was scheduled in, echoed back in the reply
+  crimson::dmclock::PhaseType qos_resp = crimson::dmclock::PhaseType::priority;
 
 public:
   friend class MOSDOpReply;
@@ -79,6 +92,13 @@ public:
   void set_spg(spg_t p) {
     pgid = p;
   }
+  void set_qos_params(const crimson::dmclock::ReqParams& p) {
+    qos_params = p;
+    has_qos_params = true;
+  }
+  void set_qos_resp(crimson::dmclock::PhaseType phase) {
+    qos_resp = phase;
+  }
 
   // Fields decoded in partial decoding
   pg_t get_pg() const {
@@ -101,6 +121,17 @@ public:
     assert(!partial_decode_needed);
     return flags;
   }
+  bool get_has_qos_params() const {
+    assert(!partial_decode_needed);
+    return has_qos_params;
+  }
+  const crimson::dmclock::ReqParams& get_qos_params() const {
+    assert(!partial_decode_needed);
+    return qos_params;
+  }
+  crimson::dmclock::PhaseType get_qos_resp() const {
+    return qos_resp;
+  }
   osd_reqid_t get_reqid() const {
     assert(!partial_decode_needed);
     if (reqid.name != entity_name_t() || reqid.tid != 0) {
@@ -359,8 +390,12 @@ struct ceph_osd_request_head {
       encode(features, payload);
     } else {
       // latest v8 encoding with hobject_t hash separate from pgid, no
-      // reassert version
-      header.version = HEAD_VERSION;
+      // reassert version; v9 adds the dmclock request params, which
+      // pre-nautilus OSDs cannot decode
+      if (has_qos_params && HAVE_FEATURE(features, SERVER_NAUTILUS))
+	header.version = HEAD_VERSION;
+      else
+	header.version = 8;
 
       encode(pgid, payload);
       encode(hobj.get_hash(), payload);
@@ -368,6 +403,10 @@ struct ceph_osd_request_head {
       encode(flags, payload);
       encode(reqid, payload);
       encode_trace(payload, features);
+      if (header.version >= 9) {
+	encode(qos_params.delta, payload);
+	encode(qos_params.rho, payload);
+      }
 
       // -- above decoded up front; below decoded post-dispatch thread --
 
@@ -390,12 +429,22 @@ struct ceph_osd_request_head {
     }
   }
 
+  size_t get_payload_bound(uint64_t features) const override {
+    // only the latest encoding is sized; its fixed fields, with their
+    // encoding headers and the trace, come to under 200 bytes
+    if (!HAVE_FEATURE(features, RESEND_ON_SPLIT))
+      return 0;
+    return 256 + hobj.oid.name.length() + hobj.get_key().length() +
+      hobj.nspace.length() + ops.size() * sizeof(ceph_osd_op) +
+      snaps.size() * sizeof(snapid_t);
+  }
+
   void decode_payload() override {
     assert(partial_decode_needed && final_decode_needed);
     p = payload.begin();
 
     // Always keep here the newest version of decoding order/rule
-    if (header.version == HEAD_VERSION) {
+    if (header.version >= 8) {
       decode(pgid, p);      // actual pgid
       uint32_t hash;
       decode(hash, p); // raw hash value
@@ -404,6 +453,16 @@ struct ceph_osd_request_head {
       decode(flags, p);
       decode(reqid, p);
       decode_trace(p);
+      if (header.version >= 9) {
+	uint32_t delta, rho;
+	decode(delta, p);
+	decode(rho, p);
+	// ReqParams asserts on these; ignore bogus values from the wire
+	if (delta && rho && rho <= delta) {
+	  qos_params = crimson::dmclock::ReqParams(delta, rho);
+	  has_qos_params = true;
+	}
+      }
     } else if (header.version == 7) {
       decode(pgid.pgid, p);      // raw pgid
       hobj.set_hash(pgid.pgid.ps());
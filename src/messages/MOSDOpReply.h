@@ -32,7 +32,7 @@
 
 class MOSDOpReply : public Message {
 
-  static const int HEAD_VERSION = 8;
+  static const int HEAD_VERSION = 9;
   static const int COMPAT_VERSION = 2;
 
   object_t oid;
@@ -48,8 +48,13 @@ class MOSDOpReply : public Message {
   int32_t retry_attempt = -1;
   bool do_redirect;
   request_redirect_t redirect;
+  // dmclock phase, only for requests that carried qos params (v9)
+  bool has_qos_resp = false;
+  crimson::dmclock::PhaseType qos_resp = crimson::dmclock::PhaseType::priority;
 
 public:
+  MEMPOOL_CLASS_HELPERS();
+
   const object_t& get_oid() const { return oid; }
   const pg_t&     get_pg() const { return pgid; }
   int      get_flags() const { return flags; }
@@ -95,6 +100,9 @@ public:
   const request_redirect_t& get_redirect() const { return redirect; }
   bool is_redirect_reply() const { return do_redirect; }
 
+  bool get_has_qos_resp() const { return has_qos_resp; }
+  crimson::dmclock::PhaseType get_qos_resp() const { return qos_resp; }
+
   void add_flags(int f) { flags |= f; }
 
   void claim_op_out_data(vector<OSDOp>& o) {
@@ -145,6 +153,8 @@ public:
     user_version = 0;
     retry_attempt = req->get_retry_attempt();
     do_redirect = false;
+    has_qos_resp = req->has_qos_params;
+    qos_resp = req->qos_resp;
 
     // zero out ops payload_len and possibly out data
     for (unsigned i = 0; i < ops.size(); i++) {
@@ -181,7 +191,10 @@ public:
       }
       encode_nohead(oid.name, payload);
     } else {
-      header.version = HEAD_VERSION;
+      if (has_qos_resp && HAVE_FEATURE(features, SERVER_NAUTILUS))
+	header.version = HEAD_VERSION;
+      else
+	header.version = 8;
       encode(oid, payload);
       encode(pgid, payload);
       encode(flags, payload);
@@ -212,14 +225,27 @@ public:
         }
       }
       encode_trace(payload, features);
+      if (header.version >= 9) {
+	encode((uint8_t)qos_resp, payload);
+      }
     }
   }
+  size_t get_payload_bound(uint64_t features) const override {
+    // the fixed fields and trace of the latest encoding come to about
+    // 100 bytes; redirects are rare enough to be left unsized
+    if (!HAVE_FEATURE(features, NEW_OSDOPREPLY_ENCODING) ||
+	!redirect.empty())
+      return 0;
+    return 128 + oid.name.length() +
+      ops.size() * (sizeof(ceph_osd_op) + sizeof(int32_t));
+  }
+
   void decode_payload() override {
     using ceph::decode;
     bufferlist::iterator p = payload.begin();
 
     // Always keep here the newest version of decoding order/rule
-    if (header.version == HEAD_VERSION) {
+    if (header.version >= 8) {
       decode(oid, p);
       decode(pgid, p);
       decode(flags, p);
@@ -245,6 +271,13 @@ public:
       if (do_redirect)
 	decode(redirect, p);
       decode_trace(p);
+      if (header.version >= 9) {
+	uint8_t phase;
+	decode(phase, p);
+	qos_resp = phase ? crimson::dmclock::PhaseType::priority :
+	  crimson::dmclock::PhaseType::reservation;
+	has_qos_resp = true;
+      }
     } else if (header.version < 2) {
       ceph_osd_reply_head head;
       decode(head, p);
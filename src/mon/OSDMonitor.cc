@@ -6703,7 +6703,13 @@ int OSDMonitor::prepare_command_pool_set(const cmdmap_t& cmdmap,
 	p.hit_set_params = HitSet::Params(new ExplicitHashHitSet::Params);
       else if (val == "explicit_object")
 	p.hit_set_params = HitSet::Params(new ExplicitObjectHitSet::Params);
-      else {
+      else if (val == "count_min") {
+	if (osdmap.require_osd_release < CEPH_RELEASE_NAUTILUS) {
+	  ss << "hit_set_type count_min requires require_osd_release >= nautilus";
+	  return -EPERM;
+	}
+	p.hit_set_params = HitSet::Params(new CountMinHitSet::Params);
+      } else {
 	ss << "unrecognized hit_set type '" << val << "'";
 	return -EINVAL;
       }
@@ -11450,6 +11456,14 @@ bool OSDMonitor::prepare_command_impl(MonOpRequestRef op,
       hsp = HitSet::Params(new ExplicitHashHitSet::Params);
     } else if (cache_hit_set_type == "explicit_object") {
       hsp = HitSet::Params(new ExplicitObjectHitSet::Params);
+    } else if (cache_hit_set_type == "count_min") {
+      if (osdmap.require_osd_release < CEPH_RELEASE_NAUTILUS) {
+	ss << "osd tier cache default hit set type 'count_min' requires "
+	   << "require_osd_release >= nautilus";
+	err = -EPERM;
+	goto reply;
+      }
+      hsp = HitSet::Params(new CountMinHitSet::Params);
     } else {
       ss << "osd tier cache default hit set type '"
 	 << cache_hit_set_type << "' is not a known type";
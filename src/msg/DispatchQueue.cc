@@ -28,6 +28,128 @@
 #undef dout_prefix
 #define dout_prefix *_dout << "-- " << msgr->get_myaddr() << " "
 
+enum {
+  l_dispatch_first = 96000,
+  l_dispatch_mon_queue_len,
+  l_dispatch_mon_wait,
+  l_dispatch_mgr_queue_len,
+  l_dispatch_mgr_wait,
+  l_dispatch_osd_queue_len,
+  l_dispatch_osd_wait,
+  l_dispatch_mds_queue_len,
+  l_dispatch_mds_wait,
+  l_dispatch_client_queue_len,
+  l_dispatch_client_wait,
+  l_dispatch_last,
+};
+
+static int queue_len_counter(int cls)
+{
+  return l_dispatch_mon_queue_len + 2 * cls;
+}
+
+static int wait_counter(int cls)
+{
+  return l_dispatch_mon_wait + 2 * cls;
+}
+
+DispatchQueue::DispatchQueue(CephContext *cct, Messenger *msgr, string &name)
+  : cct(cct), msgr(msgr),
+    lock("Messenger::DispatchQueue::lock" + name),
+    next_id(1),
+    local_delivery_lock("Messenger::DispatchQueue::local_delivery_lock" + name),
+    stop_local_delivery(false),
+    local_delivery_thread(this),
+    dispatch_throttler(cct, string("msgr_dispatch_throttler-") + name,
+		       cct->_conf->ms_dispatch_throttle_bytes),
+    stop(false)
+{
+  unsigned num_lanes =
+    cct->_conf->get_val<bool>("ms_dispatch_lanes") ? NUM_CLASSES : 1;
+  for (unsigned i = 0; i < num_lanes; ++i)
+    lanes.emplace_back(new Lane(this, i));
+
+  PerfCountersBuilder b(cct, string("msgr_dispatch_queue-") + name,
+			l_dispatch_first, l_dispatch_last);
+  b.add_u64(l_dispatch_mon_queue_len, "mon_queue_len",
+	    "Messages from monitors waiting for dispatch");
+  b.add_time_avg(l_dispatch_mon_wait, "mon_wait",
+		 "Time messages from monitors waited for dispatch");
+  b.add_u64(l_dispatch_mgr_queue_len, "mgr_queue_len",
+	    "Messages from managers waiting for dispatch");
+  b.add_time_avg(l_dispatch_mgr_wait, "mgr_wait",
+		 "Time messages from managers waited for dispatch");
+  b.add_u64(l_dispatch_osd_queue_len, "osd_queue_len",
+	    "Messages from OSDs waiting for dispatch");
+  b.add_time_avg(l_dispatch_osd_wait, "osd_wait",
+		 "Time messages from OSDs waited for dispatch");
+  b.add_u64(l_dispatch_mds_queue_len, "mds_queue_len",
+	    "Messages from MDSs waiting for dispatch");
+  b.add_time_avg(l_dispatch_mds_wait, "mds_wait",
+		 "Time messages from MDSs waited for dispatch");
+  b.add_u64(l_dispatch_client_queue_len, "client_queue_len",
+	    "Messages from clients waiting for dispatch");
+  b.add_time_avg(l_dispatch_client_wait, "client_wait",
+		 "Time messages from clients waited for dispatch");
+  logger = { b.create_perf_counters(), cct };
+  cct->get_perfcounters_collection()->add(logger.get());
+}
+
+int DispatchQueue::get_class(int peer_type)
+{
+  switch (peer_type) {
+  case CEPH_ENTITY_TYPE_MON:
+    return CLASS_MON;
+  case CEPH_ENTITY_TYPE_MGR:
+    return CLASS_MGR;
+  case CEPH_ENTITY_TYPE_OSD:
+    return CLASS_OSD;
+  case CEPH_ENTITY_TYPE_MDS:
+    return CLASS_MDS;
+  default:
+    return CLASS_CLIENT;
+  }
+}
+
+const char *DispatchQueue::get_class_name(int cls)
+{
+  switch (cls) {
+  case CLASS_MON:
+    return "mon";
+  case CLASS_MGR:
+    return "mgr";
+  case CLASS_OSD:
+    return "osd";
+  case CLASS_MDS:
+    return "mds";
+  case CLASS_CLIENT:
+    return "client";
+  default:
+    return "???";
+  }
+}
+
+void DispatchQueue::_note_queued(int cls, int n)
+{
+  assert(lock.is_locked());
+  class_len[cls] += n;
+  logger->set(queue_len_counter(cls), class_len[cls]);
+}
+
+void DispatchQueue::_enqueue_code(int code, Connection *con)
+{
+  Mutex::Locker l(lock);
+  if (stop)
+    return;
+  int cls = get_class(con->get_peer_type());
+  Lane& lane = get_lane(cls);
+  lane.mqueue.enqueue_strict(
+    0,
+    CEPH_MSG_PRIO_HIGHEST,
+    QueueItem(code, con, cls));
+  lane.cond.Signal();
+}
+
 double DispatchQueue::get_max_age(utime_t now) const {
   Mutex::Locker l(lock);
   if (marrival.empty())
@@ -85,16 +207,23 @@ void DispatchQueue::enqueue(Message *m, int priority, uint64_t id)
     m->put();
     return;
   }
-  ldout(cct,20) << "queue " << m << " prio " << priority << dendl;
+  // class by the connection, like the connection's own events, so that
+  // they share a lane and stay ordered with its messages
+  const ConnectionRef& con = m->get_connection();
+  int cls = get_class(con ? con->get_peer_type() : m->get_source().type());
+  ldout(cct,20) << "queue " << m << " prio " << priority
+		<< " class " << get_class_name(cls) << dendl;
   add_arrival(m);
+  _note_queued(cls, 1);
+  Lane& lane = get_lane(cls);
   if (priority >= CEPH_MSG_PRIO_LOW) {
-    mqueue.enqueue_strict(
-        id, priority, QueueItem(m));
+    lane.mqueue.enqueue_strict(
+        id, priority, QueueItem(m, cls));
   } else {
-    mqueue.enqueue(
-        id, priority, m->get_cost(), QueueItem(m));
+    lane.mqueue.enqueue(
+        id, priority, m->get_cost(), QueueItem(m, cls));
   }
-  cond.Signal();
+  lane.cond.Signal();
 }
 
 void DispatchQueue::local_delivery(Message *m, int priority)
@@ -152,14 +281,19 @@ void DispatchQueue::dispatch_throttle_release(uint64_t msize)
  * end of the queue. If the queue is empty; it's removed.
  * The message is then delivered and the process starts again.
  */
-void DispatchQueue::entry()
+void DispatchQueue::entry(unsigned l)
 {
+  Lane& lane = *lanes[l];
   lock.Lock();
   while (true) {
-    while (!mqueue.empty()) {
-      QueueItem qitem = mqueue.dequeue();
-      if (!qitem.is_code())
+    while (!lane.mqueue.empty()) {
+      QueueItem qitem = lane.mqueue.dequeue();
+      if (!qitem.is_code()) {
 	remove_arrival(qitem.get_message());
+	_note_queued(qitem.cls, -1);
+	logger->tinc(wait_counter(qitem.cls),
+		     ceph::mono_clock::now() - qitem.stamp);
+      }
       lock.Unlock();
 
       if (qitem.is_code()) {
@@ -209,7 +343,7 @@ void DispatchQueue::entry()
       break;
 
     // wait for something to be put on queue
-    cond.Wait(lock);
+    lane.cond.Wait(lock);
   }
   lock.Unlock();
 }
@@ -217,13 +351,15 @@ void DispatchQueue::entry()
 void DispatchQueue::discard_queue(uint64_t id) {
   Mutex::Locker l(lock);
   list<QueueItem> removed;
-  mqueue.remove_by_class(id, &removed);
+  for (auto& lane : lanes)
+    lane->mqueue.remove_by_class(id, &removed);
   for (list<QueueItem>::iterator i = removed.begin();
        i != removed.end();
        ++i) {
     assert(!(i->is_code())); // We don't discard id 0, ever!
     Message *m = i->get_message();
     remove_arrival(m);
+    _note_queued(i->cls, -1);
     dispatch_throttle_release(m->get_dispatch_throttle_size());
     m->put();
   }
@@ -232,15 +368,23 @@ void DispatchQueue::discard_queue(uint64_t id) {
 void DispatchQueue::start()
 {
   assert(!stop);
-  assert(!dispatch_thread.is_started());
-  dispatch_thread.create("ms_dispatch");
+  assert(!is_started());
+  if (lanes.size() == 1) {
+    lanes[0]->dispatch_thread.create("ms_dispatch");
+  } else {
+    for (unsigned i = 0; i < lanes.size(); ++i) {
+      string tname = string("ms_disp_") + get_class_name(i);
+      lanes[i]->dispatch_thread.create(tname.c_str());
+    }
+  }
   local_delivery_thread.create("ms_local");
 }
 
 void DispatchQueue::wait()
 {
   local_delivery_thread.join();
-  dispatch_thread.join();
+  for (auto& lane : lanes)
+    lane->dispatch_thread.join();
 }
 
 void DispatchQueue::discard_local()
@@ -265,6 +409,7 @@ void DispatchQueue::shutdown()
   // stop my dispatch thread
   lock.Lock();
   stop = true;
-  cond.Signal();
+  for (auto& lane : lanes)
+    lane->cond.Signal();
   lock.Unlock();
 }
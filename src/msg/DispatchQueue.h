@@ -17,6 +17,8 @@
 
 #include <atomic>
 #include <map>
+#include <memory>
+#include <vector>
 #include <boost/intrusive_ptr.hpp>
 #include "include/assert.h"
 #include "include/xlist.h"
@@ -24,6 +26,8 @@
 #include "common/Cond.h"
 #include "common/Thread.h"
 #include "common/PrioritizedQueue.h"
+#include "common/ceph_time.h"
+#include "common/perf_counters.h"
 
 class CephContext;
 class Messenger;
@@ -35,15 +39,41 @@ struct Connection;
  * they want to be dispatched, carefully organized by Message priority
  * and permitted to deliver in a round-robin fashion.
  * See Messenger::dispatch_entry for details.
+ *
+ * Messages and connection events are classed by the peer type of their
+ * connection (mon, mgr, osd, mds or client) and counted per class, so a
+ * flood from one kind of peer shows up as that class's queue depth and
+ * wait.  With ms_dispatch_lanes each class is queued in its own lane
+ * with its own dispatch thread, so that flood no longer holds up the
+ * other classes.  A connection's messages and events all fall in one
+ * class and are still delivered in order.
  */
 class DispatchQueue {
+ public:
+  enum {
+    CLASS_MON,
+    CLASS_MGR,
+    CLASS_OSD,
+    CLASS_MDS,
+    CLASS_CLIENT,
+    NUM_CLASSES
+  };
+  static int get_class(int peer_type);
+  static const char *get_class_name(int cls);
+
+ private:
   class QueueItem {
     int type;
     ConnectionRef con;
     MessageRef m;
   public:
-    explicit QueueItem(Message *m) : type(-1), con(0), m(m) {}
-    QueueItem(int type, Connection *con) : type(type), con(con), m(0) {}
+    int cls;
+    ceph::mono_time stamp;    ///< when queued
+    QueueItem(Message *m, int cls)
+      : type(-1), con(0), m(m), cls(cls), stamp(ceph::mono_clock::now()) {}
+    QueueItem(int type, Connection *con, int cls)
+      : type(type), con(con), m(0), cls(cls),
+	stamp(ceph::mono_clock::now()) {}
     bool is_code() const {
       return type != -1;
     }
@@ -64,9 +94,6 @@ class DispatchQueue {
   CephContext *cct;
   Messenger *msgr;
   mutable Mutex lock;
-  Cond cond;
-
-  PrioritizedQueue<QueueItem, uint64_t> mqueue;
 
   set<pair<double, Message*> > marrival;
   map<Message *, set<pair<double, Message*> >::iterator> marrival_map;
@@ -95,13 +122,35 @@ class DispatchQueue {
    */
   class DispatchThread : public Thread {
     DispatchQueue *dq;
+    unsigned lane;
   public:
-    explicit DispatchThread(DispatchQueue *dq) : dq(dq) {}
+    DispatchThread(DispatchQueue *dq, unsigned lane) : dq(dq), lane(lane) {}
     void *entry() override {
-      dq->entry();
+      dq->entry(lane);
       return 0;
     }
-  } dispatch_thread;
+  };
+
+  /// a queue and the thread that empties it
+  struct Lane {
+    PrioritizedQueue<QueueItem, uint64_t> mqueue;
+    Cond cond;
+    DispatchThread dispatch_thread;
+    Lane(DispatchQueue *dq, unsigned i)
+      : mqueue(dq->cct->_conf->ms_pq_max_tokens_per_priority,
+	       dq->cct->_conf->ms_pq_min_cost),
+	dispatch_thread(dq, i) {}
+  };
+  /// one lane, or one per class with ms_dispatch_lanes
+  std::vector<std::unique_ptr<Lane>> lanes;
+  Lane& get_lane(int cls) {
+    return *lanes[lanes.size() > 1 ? cls : 0];
+  }
+  void _enqueue_code(int code, Connection *con);
+
+  PerfCountersRef logger;
+  unsigned class_len[NUM_CLASSES] = {};
+  void _note_queued(int cls, int n);
 
   Mutex local_delivery_lock;
   Cond local_delivery_cond;
@@ -133,7 +182,10 @@ class DispatchQueue {
 
   int get_queue_len() const {
     Mutex::Locker l(lock);
-    return mqueue.length();
+    int len = 0;
+    for (auto& lane : lanes)
+      len += lane->mqueue.length();
+    return len;
   }
 
   /**
@@ -144,54 +196,19 @@ class DispatchQueue {
   void dispatch_throttle_release(uint64_t msize);
 
   void queue_connect(Connection *con) {
-    Mutex::Locker l(lock);
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_CONNECT, con));
-    cond.Signal();
+    _enqueue_code(D_CONNECT, con);
   }
   void queue_accept(Connection *con) {
-    Mutex::Locker l(lock);
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_ACCEPT, con));
-    cond.Signal();
+    _enqueue_code(D_ACCEPT, con);
   }
   void queue_remote_reset(Connection *con) {
-    Mutex::Locker l(lock);
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_BAD_REMOTE_RESET, con));
-    cond.Signal();
+    _enqueue_code(D_BAD_REMOTE_RESET, con);
   }
   void queue_reset(Connection *con) {
-    Mutex::Locker l(lock);
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_BAD_RESET, con));
-    cond.Signal();
+    _enqueue_code(D_BAD_RESET, con);
   }
   void queue_refused(Connection *con) {
-    Mutex::Locker l(lock);
-    if (stop)
-      return;
-    mqueue.enqueue_strict(
-      0,
-      CEPH_MSG_PRIO_HIGHEST,
-      QueueItem(D_CONN_REFUSED, con));
-    cond.Signal();
+    _enqueue_code(D_CONN_REFUSED, con);
   }
 
   bool can_fast_dispatch(const Message *m) const;
@@ -204,27 +221,17 @@ class DispatchQueue {
     return next_id++;
   }
   void start();
-  void entry();
+  void entry(unsigned lane);
   void wait();
   void shutdown();
-  bool is_started() const {return dispatch_thread.is_started();}
-
-  DispatchQueue(CephContext *cct, Messenger *msgr, string &name)
-    : cct(cct), msgr(msgr),
-      lock("Messenger::DispatchQueue::lock" + name),
-      mqueue(cct->_conf->ms_pq_max_tokens_per_priority,
-	     cct->_conf->ms_pq_min_cost),
-      next_id(1),
-      dispatch_thread(this),
-      local_delivery_lock("Messenger::DispatchQueue::local_delivery_lock" + name),
-      stop_local_delivery(false),
-      local_delivery_thread(this),
-      dispatch_throttler(cct, string("msgr_dispatch_throttler-") + name,
-                         cct->_conf->ms_dispatch_throttle_bytes),
-      stop(false)
-    {}
+  bool is_started() const {
+    return lanes[0]->dispatch_thread.is_started();
+  }
+
+  DispatchQueue(CephContext *cct, Messenger *msgr, string &name);
   ~DispatchQueue() {
-    assert(mqueue.empty());
+    for (auto& lane : lanes)
+      assert(lane->mqueue.empty());
     assert(marrival.empty());
     assert(local_messages.empty());
   }
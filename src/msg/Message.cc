@@ -200,11 +200,19 @@
 
 #define dout_subsys ceph_subsys_ms
 
+// account the per-op messages, which come and go at op rate
+MEMPOOL_DEFINE_OBJECT_FACTORY(MOSDOp, mosdop, msgr);
+MEMPOOL_DEFINE_OBJECT_FACTORY(MOSDOpReply, mosdopreply, msgr);
+MEMPOOL_DEFINE_OBJECT_FACTORY(MOSDRepOp, mosdrepop, msgr);
+
 void Message::encode(uint64_t features, int crcflags)
 {
   // encode and copy out of *m
   if (empty_payload()) {
     assert(middle.length() == 0);
+    size_t bound = get_payload_bound(features);
+    if (bound)
+      payload.reserve(bound);
     encode_payload(features);
 
     if (byte_throttler) {
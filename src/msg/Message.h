@@ -479,6 +479,15 @@ public:
   // virtual bits
   virtual void decode_payload() = 0;
   virtual void encode_payload(uint64_t features) = 0;
+  /**
+   * upper bound on what encode_payload() will append, or 0 if unknown
+   *
+   * Lets encode() allocate the front in one buffer of about the right
+   * size instead of starting from a generic append buffer.
+   */
+  virtual size_t get_payload_bound(uint64_t features) const {
+    return 0;
+  }
   virtual const char *get_type_name() const = 0;
   virtual void print(ostream& out) const {
     out << get_type_name() << " magic: " << magic;
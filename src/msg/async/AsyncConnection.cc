@@ -98,9 +98,12 @@ class C_tick_wakeup : public EventCallback {
   }
 };
 
-static void alloc_aligned_buffer(bufferlist& data, unsigned len, unsigned off)
+static void alloc_aligned_buffer(AlignedBufferPool *pool, bufferlist& data,
+				 unsigned len, unsigned off)
 {
-  // create a buffer to read into that matches the data alignment
+  // create a buffer to read into that matches the data alignment, so
+  // that page aligned parts of the object are page aligned in memory
+  // and can go to O_DIRECT without another copy
   unsigned alloc_len = 0;
   unsigned left = len;
   unsigned head = 0;
@@ -111,9 +114,11 @@ static void alloc_aligned_buffer(bufferlist& data, unsigned len, unsigned off)
     left -= head;
   }
   alloc_len += left;
-  bufferptr ptr(buffer::create_page_aligned(alloc_len));
-  if (head)
+  bufferptr ptr(pool->get(alloc_len));
+  if (head) {
     ptr.set_offset(CEPH_PAGE_SIZE - head);
+    ptr.set_length(len);
+  }
   data.push_back(std::move(ptr));
 }
 
@@ -474,6 +479,11 @@ void AsyncConnection::process()
           middle.clear();
           data.clear();
           current_header = header;
+          rx_crc = !(header.reserved & CEPH_MSG_HEADER_COMPRESSED) &&
+            (msgr->crcflags & (MSG_CRC_HEADER | MSG_CRC_DATA));
+          rx_front_crc = rx_middle_crc = rx_data_crc = 0;
+          rx_data_seg_crc = 0;
+          rx_data_seg_off = 0;
           state = STATE_OPEN_MESSAGE_THROTTLE_MESSAGE;
           break;
         }
@@ -551,7 +561,8 @@ void AsyncConnection::process()
           unsigned front_len = current_header.front_len;
           if (front_len) {
             if (!front.length())
-              front.push_back(buffer::create(front_len));
+              front.push_back(worker->rx_small_buffers.get(current_header.type,
+                                                            front_len));
 
             r = read_until(front_len, front.c_str());
             if (r < 0) {
@@ -561,6 +572,9 @@ void AsyncConnection::process()
               break;
             }
 
+            if (rx_crc && (async_msgr->crcflags & MSG_CRC_HEADER))
+              rx_front_crc = ceph_crc32c(0, (unsigned char *)front.c_str(),
+                                         front_len);
             ldout(async_msgr->cct, 20) << __func__ << " got front " << front.length() << dendl;
           }
           state = STATE_OPEN_MESSAGE_READ_MIDDLE;
@@ -572,7 +586,8 @@ void AsyncConnection::process()
           unsigned middle_len = current_header.middle_len;
           if (middle_len) {
             if (!middle.length())
-              middle.push_back(buffer::create(middle_len));
+              middle.push_back(worker->rx_small_buffers.get(current_header.type,
+                                                            middle_len));
 
             r = read_until(middle_len, middle.c_str());
             if (r < 0) {
@@ -581,6 +596,9 @@ void AsyncConnection::process()
             } else if (r > 0) {
               break;
             }
+            if (rx_crc && (async_msgr->crcflags & MSG_CRC_HEADER))
+              rx_middle_crc = ceph_crc32c(0, (unsigned char *)middle.c_str(),
+                                          middle_len);
             ldout(async_msgr->cct, 20) << __func__ << " got middle " << middle.length() << dendl;
           }
 
@@ -593,9 +611,10 @@ void AsyncConnection::process()
           unsigned data_len = le32_to_cpu(current_header.data_len);
           unsigned data_off = le32_to_cpu(current_header.data_off);
           if (data_len) {
-            // get a buffer
+            // get a buffer; compressed data can't land in a caller's buffer
+            bool compressed = current_header.reserved & CEPH_MSG_HEADER_COMPRESSED;
             map<ceph_tid_t,pair<bufferlist,int> >::iterator p = rx_buffers.find(current_header.tid);
-            if (p != rx_buffers.end()) {
+            if (!compressed && p != rx_buffers.end()) {
               ldout(async_msgr->cct,10) << __func__ << " seleting rx buffer v " << p->second.second
                                   << " at offset " << data_off
                                   << " len " << p->second.first.length() << dendl;
@@ -606,7 +625,8 @@ void AsyncConnection::process()
               data_blp = data_buf.begin();
             } else {
               ldout(async_msgr->cct,20) << __func__ << " allocating new rx buffer at offset " << data_off << dendl;
-              alloc_aligned_buffer(data_buf, data_len, data_off);
+              alloc_aligned_buffer(worker->rx_buffer_pool.get(), data_buf,
+                                   data_len, data_off);
               data_blp = data_buf.begin();
             }
           }
@@ -624,12 +644,20 @@ void AsyncConnection::process()
             if (r < 0) {
               ldout(async_msgr->cct, 1) << __func__ << " read data error " << dendl;
               goto fail;
-            } else if (r > 0) {
-              break;
             }
+            // crc whatever has landed while it is still in cache
+            update_rx_data_crc(bp.c_str(), r > 0 ? state_offset : read);
+            if (r > 0)
+              break;
 
             data_blp.advance(read);
             data.append(bp, 0, read);
+            if (rx_crc && (async_msgr->crcflags & MSG_CRC_DATA)) {
+              // so a resend of this data (e.g. to replicas) reuses it
+              bufferptr(bp, 0, read).set_crc32c(rx_data_seg_crc, rx_data_crc);
+              rx_data_seg_crc = rx_data_crc;
+              rx_data_seg_off = 0;
+            }
             msg_left -= read;
           }
 
@@ -676,9 +704,25 @@ void AsyncConnection::process()
             goto fail;
           }
 
+          if (current_header.reserved & CEPH_MSG_HEADER_COMPRESSED) {
+            r = decompress_message();
+            if (r < 0) {
+              ldout(async_msgr->cct, 1) << __func__ << " decompress message failed: "
+                                        << cpp_strerror(r) << dendl;
+              goto fail;
+            }
+          }
+
+          int crcflags = async_msgr->crcflags;
+          if (rx_crc) {
+            if (!verify_rx_crc(footer))
+              goto fail;
+            crcflags = 0;
+          }
+
           ldout(async_msgr->cct, 20) << __func__ << " got " << front.length() << " + " << middle.length()
                               << " + " << data.length() << " byte message" << dendl;
-          Message *message = decode_message(async_msgr->cct, async_msgr->crcflags, current_header, footer,
+          Message *message = decode_message(async_msgr->cct, crcflags, current_header, footer,
                                             front, middle, data, this);
           if (!message) {
             ldout(async_msgr->cct, 1) << __func__ << " decode message failed " << dendl;
@@ -2202,8 +2246,13 @@ ssize_t AsyncConnection::write_message(Message *m, bufferlist& bl, bool more)
     }
   }
   
+  // compression only changes what goes on the wire; the peer restores
+  // the original header, which the crcs and signature cover
+  ceph_msg_header wire_header = header;
+  maybe_compress_message(wire_header, bl);
+
   outcoming_bl.append(CEPH_MSGR_TAG_MSG);
-  outcoming_bl.append((char*)&header, sizeof(header));
+  outcoming_bl.append((char*)&wire_header, sizeof(wire_header));
 
   ldout(async_msgr->cct, 20) << __func__ << " sending message type=" << header.type
                              << " src " << entity_name_t(header.src)
@@ -2257,6 +2306,175 @@ ssize_t AsyncConnection::write_message(Message *m, bufferlist& bl, bool more)
   return rc;
 }
 
+void AsyncConnection::maybe_compress_message(ceph_msg_header &header,
+                                             bufferlist &bl)
+{
+  if (!HAVE_FEATURE(get_features(), MSG_COMPRESSION))
+    return;
+  Compressor *compressor = async_msgr->get_compressor(peer_type);
+  if (!compressor || bl.length() < async_msgr->get_compress_min_size())
+    return;
+
+  auto start = ceph::mono_clock::now();
+  bufferlist compressed;
+  int r = compressor->compress(bl, compressed);
+  logger->tinc(l_msgr_running_compress_time, ceph::mono_clock::now() - start);
+  // the algorithm and original header go in front, uncompressed
+  unsigned overhead = sizeof(__u8) + sizeof(header);
+  if (r < 0 || compressed.length() + overhead >= bl.length()) {
+    ldout(async_msgr->cct, 20) << __func__ << " sending " << bl.length()
+                               << " bytes uncompressed (r=" << r << ")" << dendl;
+    return;
+  }
+
+  bufferlist wire;
+  __u8 alg = compressor->get_type();
+  encode(alg, wire);
+  wire.append((char*)&header, sizeof(header));
+  wire.claim_append(compressed);
+  ldout(async_msgr->cct, 20) << __func__ << " " << bl.length() << " -> "
+                             << wire.length() << " bytes with "
+                             << compressor->get_type_name() << dendl;
+  logger->inc(l_msgr_send_compressed_messages);
+  logger->inc(l_msgr_send_compress_in_bytes, bl.length());
+  logger->inc(l_msgr_send_compress_out_bytes, wire.length());
+
+  header.front_len = 0;
+  header.middle_len = 0;
+  header.data_len = wire.length();
+  header.data_off = 0;
+  header.reserved = CEPH_MSG_HEADER_COMPRESSED;
+  if (msgr->crcflags & MSG_CRC_HEADER)
+    header.crc = ceph_crc32c(0, (unsigned char *)&header,
+                             sizeof(header) - sizeof(header.crc));
+  bl.swap(wire);
+}
+
+void AsyncConnection::update_rx_data_crc(const char *p, unsigned landed)
+{
+  if (!rx_crc || !(async_msgr->crcflags & MSG_CRC_DATA) ||
+      landed <= rx_data_seg_off)
+    return;
+  rx_data_crc = ceph_crc32c(rx_data_crc,
+                            (const unsigned char *)p + rx_data_seg_off,
+                            landed - rx_data_seg_off);
+  rx_data_seg_off = landed;
+}
+
+bool AsyncConnection::verify_rx_crc(const ceph_msg_footer& footer)
+{
+  // the same checks decode_message() makes, on the crcs taken as the
+  // message was read
+  if (async_msgr->crcflags & MSG_CRC_HEADER) {
+    if (rx_front_crc != footer.front_crc) {
+      ldout(async_msgr->cct, 0) << __func__ << " bad crc in front " << rx_front_crc
+                                << " != exp " << footer.front_crc << dendl;
+      return false;
+    }
+    if (rx_middle_crc != footer.middle_crc) {
+      ldout(async_msgr->cct, 0) << __func__ << " bad crc in middle " << rx_middle_crc
+                                << " != exp " << footer.middle_crc << dendl;
+      return false;
+    }
+  }
+  if ((async_msgr->crcflags & MSG_CRC_DATA) &&
+      (footer.flags & CEPH_MSG_FOOTER_NOCRC) == 0 &&
+      rx_data_crc != footer.data_crc) {
+    ldout(async_msgr->cct, 0) << __func__ << " bad crc in data " << rx_data_crc
+                              << " != exp " << footer.data_crc << dendl;
+    return false;
+  }
+  return true;
+}
+
+int AsyncConnection::decompress_message()
+{
+  auto start = ceph::mono_clock::now();
+  bufferlist::iterator p = data.begin();
+  __u8 alg;
+  ceph_msg_header header;
+  try {
+    decode(alg, p);
+    p.copy(sizeof(header), (char*)&header);
+  } catch (buffer::error& e) {
+    return -EINVAL;
+  }
+  if (!rx_compressor || rx_compressor->get_type() != alg) {
+    rx_compressor = Compressor::create(async_msgr->cct, alg);
+    if (!rx_compressor) {
+      ldout(async_msgr->cct, 0) << __func__ << " no compressor for algorithm "
+                                << (int)alg << dendl;
+      return -EOPNOTSUPP;
+    }
+  }
+
+  // the section lengths come from the peer.  Check them, and charge the
+  // throttlers for the decompressed size, before inflating anything: a
+  // message no byte throttle would let through is refused outright, and
+  // since the event loop must not block, one that does not fit right now
+  // fails the connection rather than overrunning the throttle.
+  uint64_t raw_size = (uint64_t)header.front_len + header.middle_len +
+                      header.data_len;
+  Throttle *dispatch_throttler = &dispatch_queue->dispatch_throttler;
+  if ((policy.throttler_bytes && policy.throttler_bytes->get_max() &&
+       raw_size > (uint64_t)policy.throttler_bytes->get_max()) ||
+      (dispatch_throttler->get_max() &&
+       raw_size > (uint64_t)dispatch_throttler->get_max())) {
+    ldout(async_msgr->cct, 0) << __func__ << " decompressed size " << raw_size
+                              << " exceeds the byte throttles" << dendl;
+    return -EMSGSIZE;
+  }
+  if (raw_size > cur_msg_size) {
+    uint64_t delta = raw_size - cur_msg_size;
+    if (policy.throttler_bytes &&
+        !policy.throttler_bytes->get_or_fail(delta)) {
+      ldout(async_msgr->cct, 1) << __func__ << " no room for " << delta
+                                << " decompressed bytes in policy throttler"
+                                << dendl;
+      return -EBUSY;
+    }
+    if (!dispatch_throttler->get_or_fail(delta)) {
+      ldout(async_msgr->cct, 1) << __func__ << " no room for " << delta
+                                << " decompressed bytes in dispatch throttler"
+                                << dendl;
+      if (policy.throttler_bytes)
+        policy.throttler_bytes->put(delta);
+      return -EBUSY;
+    }
+    // reset_recv_state() puts back cur_msg_size if we fail from here on
+    cur_msg_size = raw_size;
+  }
+
+  bufferlist raw;
+  int r = rx_compressor->decompress(p, data.length() - p.get_off(), raw);
+  if (r < 0)
+    return r;
+  if (raw.length() != raw_size)
+    return -EINVAL;
+
+  front.clear();
+  middle.clear();
+  data.clear();
+  raw.splice(0, header.front_len, &front);
+  raw.splice(0, header.middle_len, &middle);
+  data.claim(raw);
+  current_header = header;
+
+  // the message puts back its decompressed length when it is released
+  if (raw_size < cur_msg_size) {
+    uint64_t delta = cur_msg_size - raw_size;
+    ldout(async_msgr->cct, 20) << __func__ << " rethrottling " << cur_msg_size
+                               << " -> " << raw_size << " bytes" << dendl;
+    if (policy.throttler_bytes)
+      policy.throttler_bytes->put(delta);
+    dispatch_queue->dispatch_throttle_release(delta);
+    cur_msg_size = raw_size;
+  }
+  logger->inc(l_msgr_recv_compressed_messages);
+  logger->tinc(l_msgr_running_decompress_time, ceph::mono_clock::now() - start);
+  return 0;
+}
+
 void AsyncConnection::reset_recv_state()
 {
   // clean up state internal variables and states
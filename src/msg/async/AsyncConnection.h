@@ -27,6 +27,7 @@
 #include "auth/AuthSessionHandler.h"
 #include "common/ceph_time.h"
 #include "common/perf_counters.h"
+#include "compressor/Compressor.h"
 #include "include/buffer.h"
 #include "msg/Connection.h"
 #include "msg/Messenger.h"
@@ -73,6 +74,10 @@ class AsyncConnection : public Connection {
   void handle_ack(uint64_t seq);
   void _append_keepalive_or_ack(bool ack=false, utime_t *t=NULL);
   ssize_t write_message(Message *m, bufferlist& bl, bool more);
+  void maybe_compress_message(ceph_msg_header &header, bufferlist &bl);
+  int decompress_message();
+  void update_rx_data_crc(const char *p, unsigned landed);
+  bool verify_rx_crc(const ceph_msg_footer& footer);
   void inject_delay();
   ssize_t _reply_accept(char tag, ceph_msg_connect &connect, ceph_msg_connect_reply &reply,
                     bufferlist &authorizer_reply) {
@@ -343,6 +348,13 @@ class AsyncConnection : public Connection {
   bufferlist data_buf;
   bufferlist::iterator data_blp;
   bufferlist front, middle, data;
+  // crcs of the message being read, taken as each part lands rather than
+  // over the whole message once it is in.  not for compressed messages,
+  // whose crcs cover the payload before compression
+  bool rx_crc = false;
+  __u32 rx_front_crc = 0, rx_middle_crc = 0, rx_data_crc = 0;
+  __u32 rx_data_seg_crc = 0;     ///< rx_data_crc before the current segment
+  unsigned rx_data_seg_off = 0;  ///< bytes of the segment in rx_data_crc
   ceph_msg_connect connect_msg;
   // Connecting state
   bool got_bad_auth;
@@ -368,6 +380,7 @@ class AsyncConnection : public Connection {
   Worker *worker;
   EventCenter *center;
   ceph::shared_ptr<AuthSessionHandler> session_security;
+  CompressorRef rx_compressor;  ///< for compressed incoming messages
 
  public:
   // used by eventcallback
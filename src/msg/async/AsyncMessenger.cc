@@ -273,6 +273,26 @@ AsyncMessenger::AsyncMessenger(CephContext *cct, entity_name_t name,
     processor_num = stack->get_num_worker();
   for (unsigned i = 0; i < processor_num; ++i)
     processors.push_back(new Processor(this, stack->get_worker(i), cct));
+
+  std::string compress_types = cct->_conf->get_val<std::string>(
+    "ms_compress_peer_types");
+  if (!compress_types.empty()) {
+    for (int t : {CEPH_ENTITY_TYPE_MON, CEPH_ENTITY_TYPE_MDS,
+		  CEPH_ENTITY_TYPE_OSD, CEPH_ENTITY_TYPE_CLIENT,
+		  CEPH_ENTITY_TYPE_MGR}) {
+      if (compress_types.find(ceph_entity_type_name(t)) != string::npos)
+	compress_peer_types |= t;
+    }
+    std::string alg = cct->_conf->get_val<std::string>(
+      "ms_compress_algorithm");
+    compressor = Compressor::create(cct, alg);
+    if (!compressor) {
+      lderr(cct) << __func__ << " unable to load compressor " << alg
+		 << ", messages will not be compressed" << dendl;
+      compress_peer_types = 0;
+    }
+  }
+  compress_min_size = cct->_conf->get_val<uint64_t>("ms_compress_min_size");
 }
 
 /**
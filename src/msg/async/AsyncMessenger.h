@@ -297,6 +297,11 @@ private:
   /// internal cluster protocol version, if any, for talking to entities of the same type.
   int cluster_protocol;
 
+  /// message compression, set up from the ms_compress_* options
+  CompressorRef compressor;
+  int compress_peer_types = 0;  ///< mask of CEPH_ENTITY_TYPE_*
+  uint64_t compress_min_size = 0;
+
   Cond  stop_cond;
   bool stopped;
 
@@ -410,6 +415,17 @@ public:
    */
   int get_proto_version(int peer_type, bool connect) const;
 
+  /**
+   * Get the compressor for messages sent to the given peer type, or
+   * NULL if they go uncompressed (see ms_compress_peer_types).
+   */
+  Compressor *get_compressor(int peer_type) const {
+    return (compress_peer_types & peer_type) ? compressor.get() : nullptr;
+  }
+  uint64_t get_compress_min_size() const {
+    return compress_min_size;
+  }
+
   /**
    * Fill in the address and peer type for the local connection, which
    * is used for delivering messages back to ourself.
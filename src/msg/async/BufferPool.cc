@@ -0,0 +1,119 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include <stdlib.h>
+#include <mutex>
+
+#include "BufferPool.h"
+#include "common/deleter.h"
+#include "include/mempool.h"
+#include "include/page.h"
+#include "msg/Message.h"
+
+AlignedBufferPool::AlignedBufferPool(size_t max_bytes)
+  : free_lists(NUM_CLASSES), max_bytes(max_bytes)
+{
+}
+
+AlignedBufferPool::~AlignedBufferPool()
+{
+  ssize_t items = 0;
+  for (auto& l : free_lists) {
+    for (auto p : l) {
+      ::free(p);
+    }
+    items += l.size();
+  }
+  mempool::get_pool(mempool::mempool_msgr).adjust_count(
+    -items, -(ssize_t)cached_bytes);
+}
+
+ceph::bufferptr AlignedBufferPool::get(unsigned len)
+{
+  unsigned pages = (len + CEPH_PAGE_SIZE - 1) / CEPH_PAGE_SIZE;
+  unsigned cls = 0;
+  while ((1u << cls) < pages)
+    ++cls;
+  size_t size = (size_t)CEPH_PAGE_SIZE << cls;
+  // rounding up to the class must not waste more than a quarter of it;
+  // the OSD may hold these until the write commits
+  if (!max_bytes || cls >= NUM_CLASSES || size - len > size / 4)
+    return ceph::buffer::create_page_aligned(len);
+
+  char *p = nullptr;
+  {
+    std::lock_guard<ceph::spinlock> l(lock);
+    auto& fl = free_lists[cls];
+    if (!fl.empty()) {
+      p = fl.back();
+      fl.pop_back();
+      cached_bytes -= size;
+      mempool::get_pool(mempool::mempool_msgr).adjust_count(-1, -(ssize_t)size);
+    }
+  }
+  if (!p) {
+    if (::posix_memalign((void**)&p, CEPH_PAGE_SIZE, size))
+      throw ceph::buffer::bad_alloc();
+  }
+  // back to the pool when the last reference goes away
+  ceph::bufferptr bp(ceph::buffer::claim_buffer(
+    size, p, make_deleter([pool = shared_from_this(), p, cls]() {
+	pool->put(p, cls);
+      })));
+  bp.set_length(len);
+  return bp;
+}
+
+void AlignedBufferPool::put(char *p, unsigned cls)
+{
+  size_t size = (size_t)CEPH_PAGE_SIZE << cls;
+  {
+    std::lock_guard<ceph::spinlock> l(lock);
+    if (cached_bytes + size <= max_bytes) {
+      free_lists[cls].push_back(p);
+      cached_bytes += size;
+      mempool::get_pool(mempool::mempool_msgr).adjust_count(1, size);
+      return;
+    }
+  }
+  ::free(p);
+}
+
+// the client op path: these decode their fronts by value, so a front is
+// released along with its message
+static bool front_released_with_message(int msg_type)
+{
+  switch (msg_type) {
+  case CEPH_MSG_OSD_OP:
+  case CEPH_MSG_OSD_OPREPLY:
+  case MSG_OSD_REPOPREPLY:
+    return true;
+  default:
+    return false;
+  }
+}
+
+ceph::bufferptr SmallBufferArena::get(int msg_type, unsigned len)
+{
+  if (len > MAX_SMALL || !front_released_with_message(msg_type))
+    return ceph::buffer::create(len);
+  if (!chunk.have_raw() || used + len > CHUNK_SIZE) {
+    chunk = ceph::buffer::create(CHUNK_SIZE);
+    // create_in_mempool() leaves buffers of two pages and up unaccounted
+    chunk.reassign_to_mempool(mempool::mempool_msgr);
+    used = 0;
+  }
+  ceph::bufferptr bp(chunk, used, len);
+  // keep the next one 8 byte aligned
+  used += (len + 7) & ~7u;
+  return bp;
+}
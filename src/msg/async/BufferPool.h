@@ -0,0 +1,80 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef CEPH_MSG_ASYNC_BUFFERPOOL_H
+#define CEPH_MSG_ASYNC_BUFFERPOOL_H
+
+#include <memory>
+#include <vector>
+
+#include "include/buffer.h"
+#include "include/spinlock.h"
+
+/**
+ * Page aligned buffers for incoming message data, recycled per worker.
+ *
+ * Buffers are handed out in power-of-two page size classes and come
+ * back when the last bufferptr referencing them goes away, usually on
+ * some other thread once the OSD has written the data, so the free
+ * lists are under a spinlock.  Up to max_bytes are kept for reuse;
+ * anything beyond that goes back to the allocator.  Lengths that fit
+ * no class well, or exceed the biggest, are not pooled.
+ */
+class AlignedBufferPool
+  : public std::enable_shared_from_this<AlignedBufferPool> {
+public:
+  /// largest class is PAGE_SIZE << (NUM_CLASSES - 1), 4MB with 4K pages
+  static const unsigned NUM_CLASSES = 11;
+
+  explicit AlignedBufferPool(size_t max_bytes);
+  ~AlignedBufferPool();
+
+  /// get a page aligned buffer of len bytes
+  ceph::bufferptr get(unsigned len);
+
+private:
+  void put(char *p, unsigned cls);
+
+  ceph::spinlock lock;
+  std::vector<std::vector<char*>> free_lists;  ///< by size class
+  size_t cached_bytes = 0;
+  const size_t max_bytes;
+};
+
+/**
+ * Small buffers for incoming message fronts and middles.
+ *
+ * Per-op messages have fronts of a few hundred bytes; rather than a
+ * malloc/free pair for each, they are carved one after another out of
+ * a shared chunk, which goes back to the allocator once every message
+ * using it is gone.  Only used from the owning worker's thread, so no
+ * locking; the chunk refcount is all that crosses threads.
+ *
+ * Anything decoded by reference out of a front pins its whole chunk,
+ * so only message types that keep nothing of their front beyond the
+ * message itself are carved; the rest get a buffer of their own.
+ */
+class SmallBufferArena {
+public:
+  /// lengths above this get a buffer of their own
+  static const unsigned MAX_SMALL = 1024;
+  static const unsigned CHUNK_SIZE = 8192;
+
+  /// get a buffer of len bytes for a message of type msg_type
+  ceph::bufferptr get(int msg_type, unsigned len);
+
+private:
+  ceph::bufferptr chunk;
+  unsigned used = 0;
+};
+
+#endif
@@ -19,8 +19,13 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
 
 #include <algorithm>
+#include <deque>
+#include <map>
 
 #include "PosixStack.h"
 
@@ -36,16 +41,90 @@
 #undef dout_prefix
 #define dout_prefix *_dout << "PosixStack "
 
+// MSG_ZEROCOPY arrived in Linux 4.14; older headers may lack these
+#if defined(__linux__) && defined(SO_EE_ORIGIN_ZEROCOPY)
+# define CEPH_HAVE_MSG_ZEROCOPY
+# ifndef SO_ZEROCOPY
+#  define SO_ZEROCOPY 60
+# endif
+# ifndef MSG_ZEROCOPY
+#  define MSG_ZEROCOPY 0x4000000
+# endif
+# ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#  define SO_EE_CODE_ZEROCOPY_COPIED 1
+# endif
+#endif
+
 class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   NetHandler &handler;
   int _fd;
   entity_addr_t sa;
   bool connected;
 
+  // MSG_ZEROCOPY: the kernel sends straight from our pages, so what we
+  // sent stays referenced until the error queue says it is done with it
+  uint64_t zerocopy_min_bytes = 0;  ///< 0 disables zerocopy sends
+  uint32_t zerocopy_next_id = 0;    ///< id the kernel gives our next send
+  uint32_t zerocopy_done = 0;       ///< all ids before this are complete
+  std::map<uint32_t, uint32_t> zerocopy_done_ranges; ///< out of order
+  /// sent buffers, keyed by the last send id that covers them
+  std::deque<std::pair<uint32_t, bufferlist>> zerocopy_pending;
+
+  void reap_zerocopy() {
+#ifdef CEPH_HAVE_MSG_ZEROCOPY
+    while (true) {
+      struct msghdr msg;
+      char control[128];
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      if (::recvmsg(_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        break;
+      for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm;
+           cm = CMSG_NXTHDR(&msg, cm)) {
+        if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+            !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))
+          continue;
+        auto serr = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cm));
+        if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+          continue;
+        if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+          // the kernel copied anyway (e.g. loopback); stop paying for
+          // the notifications
+          zerocopy_min_bytes = 0;
+        }
+        // ids [ee_info, ee_data] are complete
+        zerocopy_done_ranges[serr->ee_info] = serr->ee_data;
+      }
+    }
+    for (auto p = zerocopy_done_ranges.find(zerocopy_done);
+         p != zerocopy_done_ranges.end();
+         p = zerocopy_done_ranges.find(zerocopy_done)) {
+      zerocopy_done = p->second + 1;
+      zerocopy_done_ranges.erase(p);
+    }
+    while (!zerocopy_pending.empty() &&
+           (int32_t)(zerocopy_pending.front().first - zerocopy_done) < 0) {
+      zerocopy_pending.pop_front();
+    }
+#endif
+  }
+
  public:
   explicit PosixConnectedSocketImpl(NetHandler &h, const entity_addr_t &sa, int f, bool connected)
       : handler(h), _fd(f), sa(sa), connected(connected) {}
 
+  /// send messages of at least min_bytes with MSG_ZEROCOPY, if the
+  /// kernel supports it
+  void enable_zerocopy(uint64_t min_bytes) {
+#ifdef CEPH_HAVE_MSG_ZEROCOPY
+    int on = 1;
+    if (min_bytes &&
+        ::setsockopt(_fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) == 0)
+      zerocopy_min_bytes = min_bytes;
+#endif
+  }
+
   int is_connected() override {
     if (connected)
       return 1;
@@ -66,6 +145,9 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t read(char *buf, size_t len) override {
+    // completions raise EPOLLERR, which lands here as readable
+    if (!zerocopy_pending.empty())
+      reap_zerocopy();
     ssize_t r = ::read(_fd, buf, len);
     if (r < 0)
       r = -errno;
@@ -74,21 +156,36 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
 
   // return the sent length
   // < 0 means error occurred
-  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more)
+  // zerocopy_id, if set, is the id of the next MSG_ZEROCOPY send and is
+  // advanced for each one the kernel accepts
+  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more,
+                            uint32_t *zerocopy_id = nullptr)
   {
     size_t sent = 0;
+    int zerocopy_flag = 0;
+#ifdef CEPH_HAVE_MSG_ZEROCOPY
+    if (zerocopy_id)
+      zerocopy_flag = MSG_ZEROCOPY;
+#endif
     while (1) {
       MSGR_SIGPIPE_STOPPER;
       ssize_t r;
-      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0) |
+                    zerocopy_flag);
       if (r < 0) {
         if (errno == EINTR) {
           continue;
         } else if (errno == EAGAIN) {
           break;
+        } else if (errno == ENOBUFS && zerocopy_flag) {
+          // out of notification memory (optmem_max); copy this one
+          zerocopy_flag = 0;
+          continue;
         }
         return -errno;
       }
+      if (zerocopy_flag && r > 0)
+        ++*zerocopy_id;
 
       sent += r;
       if (len == sent) break;
@@ -110,6 +207,10 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t send(bufferlist &bl, bool more) override {
+    if (!zerocopy_pending.empty())
+      reap_zerocopy();
+    bool zerocopy = zerocopy_min_bytes && bl.length() >= zerocopy_min_bytes;
+    uint32_t first_zerocopy_id = zerocopy_next_id;
     size_t sent_bytes = 0;
     std::list<bufferptr>::const_iterator pb = bl.buffers().begin();
     uint64_t left_pbrs = bl.buffers().size();
@@ -128,7 +229,8 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
 	msglen += pb->length();
 	++pb;
       }
-      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more);
+      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more,
+                             zerocopy ? &zerocopy_next_id : nullptr);
       if (r < 0)
         return r;
 
@@ -145,7 +247,12 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
         bl.splice(sent_bytes, bl.length()-sent_bytes, &swapped);
         bl.swap(swapped);
       } else {
-        bl.clear();
+        swapped.swap(bl);
+      }
+      if (zerocopy_next_id != first_zerocopy_id) {
+        // swapped now holds what was sent
+        zerocopy_pending.emplace_back(zerocopy_next_id - 1,
+                                      std::move(swapped));
       }
     }
 
@@ -156,6 +263,7 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
   void close() override {
     ::close(_fd);
+    zerocopy_pending.clear();
   }
   int fd() const override {
     return _fd;
@@ -207,6 +315,8 @@ int PosixServerSocketImpl::accept(ConnectedSocket *sock, const SocketOptions &op
   handler.set_priority(sd, opt.priority, out->get_family());
 
   std::unique_ptr<PosixConnectedSocketImpl> csi(new PosixConnectedSocketImpl(handler, *out, sd, true));
+  csi->enable_zerocopy(
+    w->cct->_conf->get_val<uint64_t>("ms_async_zerocopy_min_bytes"));
   *sock = ConnectedSocket(std::move(csi));
   return 0;
 }
@@ -273,8 +383,11 @@ int PosixWorker::connect(const entity_addr_t &addr, const SocketOptions &opts, C
   }
 
   net.set_priority(sd, opts.priority, addr.get_family());
-  *socket = ConnectedSocket(
-      std::unique_ptr<PosixConnectedSocketImpl>(new PosixConnectedSocketImpl(net, addr, sd, !opts.nonblock)));
+  std::unique_ptr<PosixConnectedSocketImpl> csi(
+      new PosixConnectedSocketImpl(net, addr, sd, !opts.nonblock));
+  csi->enable_zerocopy(
+    cct->_conf->get_val<uint64_t>("ms_async_zerocopy_min_bytes"));
+  *socket = ConnectedSocket(std::move(csi));
   return 0;
 }
 
@@ -20,6 +20,7 @@
 #include "include/spinlock.h"
 #include "common/perf_counters.h"
 #include "msg/msg_types.h"
+#include "msg/async/BufferPool.h"
 #include "msg/async/Event.h"
 
 class Worker;
@@ -198,6 +199,13 @@ enum {
   l_msgr_running_recv_time,
   l_msgr_running_fast_dispatch_time,
 
+  l_msgr_send_compressed_messages,
+  l_msgr_send_compress_in_bytes,
+  l_msgr_send_compress_out_bytes,
+  l_msgr_running_compress_time,
+  l_msgr_recv_compressed_messages,
+  l_msgr_running_decompress_time,
+
   l_msgr_last,
 };
 
@@ -215,12 +223,18 @@ class Worker {
 
   std::atomic_uint references;
   EventCenter center;
+  /// page aligned buffers for incoming message data
+  std::shared_ptr<AlignedBufferPool> rx_buffer_pool;
+  /// incoming message fronts and middles; worker thread only
+  SmallBufferArena rx_small_buffers;
 
   Worker(const Worker&) = delete;
   Worker& operator=(const Worker&) = delete;
 
   Worker(CephContext *c, unsigned i)
-    : cct(c), perf_logger(NULL), id(i), references(0), center(c) {
+    : cct(c), perf_logger(NULL), id(i), references(0), center(c),
+      rx_buffer_pool(std::make_shared<AlignedBufferPool>(
+	cct->_conf->get_val<uint64_t>("ms_async_rx_buffer_pool_bytes"))) {
     char name[128];
     sprintf(name, "AsyncMessenger::Worker-%u", id);
     // initialize perf_logger
@@ -238,6 +252,13 @@ class Worker {
     plb.add_time(l_msgr_running_recv_time, "msgr_running_recv_time", "The total time of message receiving");
     plb.add_time(l_msgr_running_fast_dispatch_time, "msgr_running_fast_dispatch_time", "The total time of fast dispatch");
 
+    plb.add_u64_counter(l_msgr_send_compressed_messages, "msgr_send_compressed_messages", "Network sent messages that were compressed");
+    plb.add_u64_counter(l_msgr_send_compress_in_bytes, "msgr_send_compress_in_bytes", "Payload bytes of compressed sent messages", NULL, 0, unit_t(BYTES));
+    plb.add_u64_counter(l_msgr_send_compress_out_bytes, "msgr_send_compress_out_bytes", "Wire bytes of compressed sent messages", NULL, 0, unit_t(BYTES));
+    plb.add_time(l_msgr_running_compress_time, "msgr_running_compress_time", "The total time of message compression");
+    plb.add_u64_counter(l_msgr_recv_compressed_messages, "msgr_recv_compressed_messages", "Network received messages that were compressed");
+    plb.add_time(l_msgr_running_decompress_time, "msgr_running_decompress_time", "The total time of message decompression");
+
     perf_logger = plb.create_perf_counters();
     cct->get_perfcounters_collection()->add(perf_logger);
   }
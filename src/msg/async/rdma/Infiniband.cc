@@ -26,7 +26,6 @@
 #define dout_prefix *_dout << "Infiniband "
 
 static const uint32_t MAX_SHARED_RX_SGE_COUNT = 1;
-static const uint32_t MAX_INLINE_DATA = 0;
 static const uint32_t TCP_MSG_LEN = sizeof("0000:00000000:00000000:00000000:00000000000000000000000000000000");
 static const uint32_t CQ_DEPTH = 30000;
 
@@ -186,11 +185,18 @@ int Infiniband::QueuePair::init()
   qpia.srq = srq;                      // use the same shared receive queue
   qpia.cap.max_send_wr  = max_send_wr; // max outstanding send requests
   qpia.cap.max_send_sge = 1;           // max send scatter-gather elements
-  qpia.cap.max_inline_data = MAX_INLINE_DATA;          // max bytes of immediate data on send q
+  qpia.cap.max_inline_data = cct->_conf->get_val<uint64_t>("ms_async_rdma_inline_size");  // max bytes of immediate data on send q
   qpia.qp_type = type;                 // RC, UC, UD, or XRC
   qpia.sq_sig_all = 0;                 // only generate CQEs on requested WQEs
 
   qp = ibv_create_qp(pd, &qpia);
+  if (qp == NULL && qpia.cap.max_inline_data) {
+    lderr(cct) << __func__ << " failed to create queue pair with "
+               << qpia.cap.max_inline_data << " bytes inline, retrying without: "
+               << cpp_strerror(errno) << dendl;
+    qpia.cap.max_inline_data = 0;
+    qp = ibv_create_qp(pd, &qpia);
+  }
   if (qp == NULL) {
     lderr(cct) << __func__ << " failed to create queue pair" << cpp_strerror(errno) << dendl;
     if (errno == ENOMEM) {
@@ -201,8 +207,10 @@ int Infiniband::QueuePair::init()
     return -1;
   }
 
+  // the provider reports back what it can actually inline
+  max_inline_data = qpia.cap.max_inline_data;
   ldout(cct, 20) << __func__ << " successfully create queue pair: "
-                 << "qp=" << qp << dendl;
+                 << "qp=" << qp << " max_inline_data=" << max_inline_data << dendl;
 
   // move from RESET to INIT state
   ibv_qp_attr qpa;
@@ -556,44 +564,72 @@ void Infiniband::MemoryManager::Chunk::clear()
   bound = 0;
 }
 
-Infiniband::MemoryManager::Cluster::Cluster(MemoryManager& m, uint32_t s)
-  : manager(m), buffer_size(s), lock("cluster_lock")
+Infiniband::MemoryManager::Cluster::Cluster(MemoryManager& m, uint32_t s,
+					    uint32_t max_chunk)
+  : manager(m), buffer_size(s), max_chunk(max_chunk), lock("cluster_lock")
 {
 }
 
 Infiniband::MemoryManager::Cluster::~Cluster()
 {
-  int r = ibv_dereg_mr(chunk_base->mr);
-  assert(r == 0);
-  const auto chunk_end = chunk_base + num_chunk;
-  for (auto chunk = chunk_base; chunk != chunk_end; chunk++) {
-    chunk->~Chunk();
+  unsigned n = num_regions;
+  for (unsigned i = 0; i < n; ++i) {
+    Region &r = regions[i];
+    int ret = ibv_dereg_mr(r.chunk_base->mr);
+    assert(ret == 0);
+    const auto chunk_end = r.chunk_base + r.num;
+    for (auto chunk = r.chunk_base; chunk != chunk_end; chunk++) {
+      chunk->~Chunk();
+    }
+    ::free(r.chunk_base);
+    manager.free(r.base);
   }
-
-  ::free(chunk_base);
-  manager.free(base);
 }
 
 int Infiniband::MemoryManager::Cluster::fill(uint32_t num)
 {
-  assert(!base);
-  num_chunk = num;
+  assert(!num_regions);
+  region_chunks = num;
+  if (max_chunk < num)
+    max_chunk = num;
+  return add_region(num);
+}
+
+// called with lock held, or before the cluster is in use
+int Infiniband::MemoryManager::Cluster::add_region(uint32_t num)
+{
+  unsigned n = num_regions;
+  if (n == MAX_REGIONS)
+    return -ENOSPC;
+  Region &r = regions[n];
   uint32_t bytes = buffer_size * num;
 
-  base = (char*)manager.malloc(bytes);
-  end = base + bytes;
-  assert(base);
-  chunk_base = static_cast<Chunk*>(::malloc(sizeof(Chunk) * num));
-  memset(chunk_base, 0, sizeof(Chunk) * num);
-  free_chunks.reserve(num);
-  ibv_mr* m = ibv_reg_mr(manager.pd->pd, base, bytes, IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_LOCAL_WRITE);
-  assert(m);
-  Chunk* chunk = chunk_base;
+  r.base = (char*)manager.malloc(bytes);
+  if (!r.base)
+    return -ENOMEM;
+  r.end = r.base + bytes;
+  ibv_mr* m = ibv_reg_mr(manager.pd->pd, r.base, bytes, IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_LOCAL_WRITE);
+  if (!m) {
+    int err = errno;
+    lderr(manager.cct) << __func__ << " failed to register " << bytes
+		       << " bytes: " << cpp_strerror(err) << dendl;
+    manager.free(r.base);
+    r.base = r.end = nullptr;
+    return -err;
+  }
+  r.chunk_base = static_cast<Chunk*>(::malloc(sizeof(Chunk) * num));
+  memset(r.chunk_base, 0, sizeof(Chunk) * num);
+  r.num = num;
+  free_chunks.reserve(num_chunk + num);
+  Chunk* chunk = r.chunk_base;
   for (uint32_t offset = 0; offset < bytes; offset += buffer_size){
-    new(chunk) Chunk(m, buffer_size, base+offset);
+    new(chunk) Chunk(m, buffer_size, r.base+offset);
     free_chunks.push_back(chunk);
     chunk++;
   }
+  num_chunk += num;
+  // publish only once the region is usable
+  num_regions.store(n + 1, std::memory_order_release);
   return 0;
 }
 
@@ -613,6 +649,13 @@ int Infiniband::MemoryManager::Cluster::get_buffers(std::vector<Chunk*> &chunks,
     --num;
   int r = num;
   Mutex::Locker l(lock);
+  if (bytes && free_chunks.size() < num && num_chunk < max_chunk) {
+    uint32_t grow = std::min(region_chunks, max_chunk - num_chunk);
+    if (add_region(grow) == 0) {
+      ldout(manager.cct, 1) << __func__ << " grew tx buffers by " << grow
+                            << " to " << num_chunk << dendl;
+    }
+  }
   if (free_chunks.empty())
     return 0;
   if (!bytes) {
@@ -813,12 +856,13 @@ void Infiniband::MemoryManager::free(void *ptr)
     std::free(ptr);
 }
 
-void Infiniband::MemoryManager::create_tx_pool(uint32_t size, uint32_t tx_num)
+void Infiniband::MemoryManager::create_tx_pool(uint32_t size, uint32_t tx_num,
+                                               uint32_t tx_max)
 {
   assert(device);
   assert(pd);
 
-  send = new Cluster(*this, size);
+  send = new Cluster(*this, size, tx_max);
   send->fill(tx_num);
 }
 
@@ -921,7 +965,9 @@ void Infiniband::init()
                 << " completion entries" << dendl;
 
   memory_manager = new MemoryManager(cct, device, pd);
-  memory_manager->create_tx_pool(cct->_conf->ms_async_rdma_buffer_size, tx_queue_len);
+  memory_manager->create_tx_pool(
+    cct->_conf->ms_async_rdma_buffer_size, tx_queue_len,
+    cct->_conf->get_val<uint64_t>("ms_async_rdma_send_buffers_max"));
 
   srq = create_shared_receive_queue(rx_queue_len, MAX_SHARED_RX_SGE_COUNT);
 
@@ -167,6 +167,7 @@ enum {
 
   l_msgr_rdma_tx_chunks,
   l_msgr_rdma_tx_bytes,
+  l_msgr_rdma_tx_inline_chunks,
   l_msgr_rdma_rx_chunks,
   l_msgr_rdma_rx_bytes,
   l_msgr_rdma_pending_sent_conns,
@@ -215,31 +216,57 @@ class Infiniband {
       char  data[0];
     };
 
+    // registered buffers are added in regions of the initial fill size,
+    // up to max_chunk in all, when get_buffers() runs out
     class Cluster {
      public:
-      Cluster(MemoryManager& m, uint32_t s);
+      Cluster(MemoryManager& m, uint32_t s, uint32_t max_chunk);
       ~Cluster();
 
       int fill(uint32_t num);
       void take_back(std::vector<Chunk*> &ck);
       int get_buffers(std::vector<Chunk*> &chunks, size_t bytes);
       Chunk *get_chunk_by_buffer(const char *c) {
-        uint32_t idx = (c - base) / buffer_size;
-        Chunk *chunk = chunk_base + idx;
-        return chunk;
+        const Region *r = get_region(c);
+        if (!r)
+          return nullptr;
+        uint32_t idx = (c - r->base) / buffer_size;
+        return r->chunk_base + idx;
       }
       bool is_my_buffer(const char *c) const {
-        return c >= base && c < end;
+        return get_region(c) != nullptr;
       }
 
       MemoryManager& manager;
       uint32_t buffer_size;
       uint32_t num_chunk = 0;
+      uint32_t max_chunk;
       Mutex lock;
       std::vector<Chunk*> free_chunks;
-      char *base = nullptr;
-      char *end = nullptr;
-      Chunk* chunk_base = nullptr;
+
+     private:
+      struct Region {
+        char *base = nullptr;
+        char *end = nullptr;
+        Chunk *chunk_base = nullptr;
+        uint32_t num = 0;
+      };
+      static const unsigned MAX_REGIONS = 16;
+
+      // regions are only ever added, so lookups need no lock
+      const Region *get_region(const char *c) const {
+        unsigned n = num_regions.load(std::memory_order_acquire);
+        for (unsigned i = 0; i < n; ++i) {
+          if (c >= regions[i].base && c < regions[i].end)
+            return &regions[i];
+        }
+        return nullptr;
+      }
+      int add_region(uint32_t num);
+
+      Region regions[MAX_REGIONS];
+      std::atomic<unsigned> num_regions = {0};
+      uint32_t region_chunks = 0;  ///< chunks per region after the first
     };
 
     class MemPoolContext {
@@ -313,7 +340,7 @@ class Infiniband {
     void* malloc(size_t size);
     void  free(void *ptr);
 
-    void create_tx_pool(uint32_t size, uint32_t tx_num);
+    void create_tx_pool(uint32_t size, uint32_t tx_num, uint32_t tx_max);
     void return_tx(std::vector<Chunk*> &chunks);
     int get_send_buffers(std::vector<Chunk*> &c, size_t bytes);
     bool is_tx_buffer(const char* c) { return send->is_my_buffer(c); }
@@ -469,6 +496,8 @@ class Infiniband {
     void dec_tx_wr(uint32_t amt) { tx_wr_inflight -= amt; }
     uint32_t get_tx_wr() const { return tx_wr_inflight; }
     ibv_qp* get_qp() const { return qp; }
+    /// sends up to this long may be posted with IBV_SEND_INLINE
+    uint32_t get_max_inline_data() const { return max_inline_data; }
     Infiniband::CompletionQueue* get_tx_cq() const { return txcq; }
     Infiniband::CompletionQueue* get_rx_cq() const { return rxcq; }
     int to_dead();
@@ -489,6 +518,7 @@ class Infiniband {
     uint32_t     max_send_wr;
     uint32_t     max_recv_wr;
     uint32_t     q_key;
+    uint32_t     max_inline_data = 0;
     bool dead;
     std::atomic<uint32_t> tx_wr_inflight = {0}; // counter for inflight Tx WQEs
   };
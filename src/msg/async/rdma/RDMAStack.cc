@@ -344,6 +344,11 @@ RDMAConnectedSocketImpl* RDMADispatcher::get_conn_lockless(uint32_t qp)
 Infiniband::QueuePair* RDMADispatcher::get_qp(uint32_t qp)
 {
   Mutex::Locker l(lock);
+  return get_qp_lockless(qp);
+}
+
+Infiniband::QueuePair* RDMADispatcher::get_qp_lockless(uint32_t qp)
+{
   // Try to find the QP in qp_conns firstly.
   auto it = qp_conns.find(qp);
   if (it != qp_conns.end())
@@ -378,6 +383,19 @@ void RDMADispatcher::handle_tx_event(ibv_wc *cqe, int n)
 {
   std::vector<Chunk*> tx_chunks;
 
+  // settle the whole batch under one lock; completions of one qp tend
+  // to come in runs, so look each run's qp up once
+  {
+    Mutex::Locker l(lock);
+    QueuePair *qp = nullptr;
+    for (int i = 0; i < n; ++i) {
+      if (!qp || qp->get_local_qp_number() != cqe[i].qp_num)
+        qp = get_qp_lockless(cqe[i].qp_num);
+      if (qp)
+        qp->dec_tx_wr(1);
+    }
+  }
+
   for (int i = 0; i < n; ++i) {
     ibv_wc* response = &cqe[i];
     Chunk* chunk = reinterpret_cast<Chunk *>(response->wr_id);
@@ -385,10 +403,6 @@ void RDMADispatcher::handle_tx_event(ibv_wc *cqe, int n)
                    << " len: " << response->byte_len << " , addr:" << chunk
                    << " " << get_stack()->get_infiniband().wc_status_to_string(response->status) << dendl;
 
-    QueuePair *qp = get_qp(response->qp_num);
-    if (qp)
-      qp->dec_tx_wr(1);
-
     if (response->status != IBV_WC_SUCCESS) {
       perf_logger->inc(l_msgr_rdma_tx_total_wc_errors);
       if (response->status == IBV_WC_RETRY_EXC_ERR) {
@@ -468,6 +482,7 @@ RDMAWorker::RDMAWorker(CephContext *c, unsigned i)
 
   plb.add_u64_counter(l_msgr_rdma_tx_chunks, "tx_chunks", "The number of tx chunks transmitted");
   plb.add_u64_counter(l_msgr_rdma_tx_bytes, "tx_bytes", "The bytes of tx chunks transmitted", NULL, 0, unit_t(BYTES));
+  plb.add_u64_counter(l_msgr_rdma_tx_inline_chunks, "tx_inline_chunks", "The number of tx chunks sent inline");
   plb.add_u64_counter(l_msgr_rdma_rx_chunks, "rx_chunks", "The number of rx chunks transmitted");
   plb.add_u64_counter(l_msgr_rdma_rx_bytes, "rx_bytes", "The bytes of rx chunks transmitted", NULL, 0, unit_t(BYTES));
   plb.add_u64_counter(l_msgr_rdma_pending_sent_conns, "pending_sent_conns", "The count of pending sent conns");
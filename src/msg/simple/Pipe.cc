@@ -690,7 +690,8 @@ int Pipe::accept()
 
   reply:
     assert(pipe_lock.is_locked());
-    reply.features = ((uint64_t)connect.features & policy.features_supported) | policy.features_required;
+    reply.features = ((uint64_t)connect.features & policy.features_supported &
+		      ~CEPH_FEATURE_MSG_COMPRESSION) | policy.features_required;
     reply.authorizer_len = authorizer_reply.length();
     pipe_lock.Unlock();
     r = tcp_write((char*)&reply, sizeof(reply));
@@ -773,7 +774,8 @@ int Pipe::accept()
 
   // send READY reply
   reply.tag = (reply_tag ? reply_tag : CEPH_MSGR_TAG_READY);
-  reply.features = policy.features_supported;
+  // Pipe can't decompress messages, so never offer MSG_COMPRESSION
+  reply.features = policy.features_supported & ~CEPH_FEATURE_MSG_COMPRESSION;
   reply.global_seq = msgr->get_global_seq();
   reply.connect_seq = connect_seq;
   reply.flags = 0;
@@ -1122,7 +1124,7 @@ int Pipe::connect()
     bufferlist authorizer_reply;
 
     ceph_msg_connect connect;
-    connect.features = policy.features_supported;
+    connect.features = policy.features_supported & ~CEPH_FEATURE_MSG_COMPRESSION;
     connect.host_type = msgr->get_myinst().name.type();
     connect.global_seq = gseq;
     connect.connect_seq = cseq;
@@ -88,6 +88,7 @@ void ClassHandler::shutdown()
     }
   }
   classes.clear();
+  ++generation;
 }
 
 /*
@@ -226,6 +227,7 @@ ClassHandler::ClassData *ClassHandler::register_class(const char *cname)
 void ClassHandler::unregister_class(ClassHandler::ClassData *cls)
 {
   /* FIXME: do we really need this one? */
+  ++generation;
 }
 
 ClassHandler::ClassMethod *ClassHandler::ClassData::register_method(const char *mname,
@@ -296,6 +298,7 @@ void ClassHandler::ClassData::unregister_method(ClassHandler::ClassMethod *metho
    map<string, ClassMethod>::iterator iter = methods_map.find(method->name);
    if (iter == methods_map.end())
      return;
+   ++handler->generation;
    methods_map.erase(iter);
 }
 
@@ -338,3 +341,39 @@ int ClassHandler::ClassMethod::exec(cls_method_context_t ctx, bufferlist& indata
   return ret;
 }
 
+
+int ClassHandler::MethodCache::get(const string& cname, const string& mname,
+				   ClassMethod **pmethod, int *pflags)
+{
+  uint64_t g = handler->generation;
+  if (g != generation) {
+    methods.clear();
+    generation = g;
+  }
+  auto p = methods.find(make_pair(cname, mname));
+  if (p != methods.end()) {
+    *pmethod = p->second.method;
+    *pflags = p->second.flags;
+    return 0;
+  }
+
+  ClassData *cls;
+  int r = handler->open_class(cname, &cls);
+  if (r)
+    return r;
+  ClassMethod *method;
+  int flags;
+  {
+    Mutex::Locker l(handler->mutex);
+    method = cls->_get_method(mname.c_str());
+    if (!method)
+      return -EOPNOTSUPP;
+    flags = method->flags;
+  }
+  if (methods.size() >= MAX_ENTRIES)
+    methods.clear();
+  methods[make_pair(cname, mname)] = Entry{method, flags};
+  *pmethod = method;
+  *pflags = flags;
+  return 0;
+}
@@ -3,6 +3,8 @@
 #ifndef CEPH_CLASSHANDLER_H
 #define CEPH_CLASSHANDLER_H
 
+#include <atomic>
+
 #include "include/types.h"
 #include "objclass/objclass.h"
 #include "common/Mutex.h"
@@ -101,8 +103,51 @@ public:
     }
   };
 
+  /**
+   * MethodCache
+   *
+   * Resolved (class, method) handles for a single user (e.g. a PG), so
+   * that a CALL op does not take the handler mutex to look up the class,
+   * the method and its flags every time.  Not thread safe; the owner
+   * serializes access with its own lock.  Entries are dropped whenever a
+   * method or class is unregistered.
+   */
+  class MethodCache {
+    struct Entry {
+      ClassMethod *method;
+      int flags;
+    };
+    ClassHandler *handler;
+    uint64_t generation = 0;
+    map<pair<string, string>, Entry> methods;
+
+  public:
+    /// entries kept before the cache is flushed
+    static const size_t MAX_ENTRIES = 128;
+
+    explicit MethodCache(ClassHandler *h) : handler(h) {}
+
+    /**
+     * look up a method
+     *
+     * @return 0 on success, -EOPNOTSUPP if the class has no such method,
+     *         or the open_class() error if the class could not be opened
+     */
+    int get(const string& cname, const string& mname,
+	    ClassMethod **pmethod, int *pflags);
+
+    void clear() {
+      methods.clear();
+    }
+    size_t size() const {
+      return methods.size();
+    }
+  };
+
 private:
   map<string, ClassData> classes;
+  /// bumped whenever a method handle may have become invalid
+  std::atomic<uint64_t> generation = {0};
 
   ClassData *_get_class(const string& cname, bool check_allowed);
   int _load_class(ClassData *cls);
@@ -90,6 +90,7 @@ ostream &operator<<(ostream &lhs, const ECBackend::read_request_t &rhs)
   return lhs << "read_request_t(to_read=[" << rhs.to_read << "]"
 	     << ", need=" << rhs.need
 	     << ", want_attrs=" << rhs.want_attrs
+	     << ", want_to_read=" << rhs.want_to_read
 	     << ")";
 }
 
@@ -1182,7 +1183,12 @@ void ECBackend::handle_sub_read_reply(
       }
       set<int> want_to_read;
       map<int, vector<pair<int, int>>> dummy_minimum;
-      get_want_to_read_shards(&want_to_read);
+      auto req = rop.to_read.find(iter->first);
+      if (req != rop.to_read.end() && !req->second.want_to_read.empty()) {
+	want_to_read = req->second.want_to_read;
+      } else {
+	get_want_to_read_shards(&want_to_read);
+      }
       int err;
       if ((err = ec_impl->minimum_to_decode(want_to_read, have, &dummy_minimum)) < 0) {
 	dout(20) << __func__ << " minimum_to_decode failed" << dendl;
@@ -1248,6 +1254,11 @@ void ECBackend::complete_read_op(ReadOp &rop, RecoveryMessages *m)
       reqiter->second.cb = nullptr;
     }
   }
+  // a redundant or hedged read may complete before every shard replies
+  for (auto &&i: rop.in_progress) {
+    shard_to_read_map[i].erase(rop.tid);
+  }
+  rop.in_progress.clear();
   tid_to_read_map.erase(rop.tid);
 }
 
@@ -1265,6 +1276,100 @@ struct FinishReadOp : public GenContext<ThreadPool::TPHandle&>  {
   }
 };
 
+struct CheckReadHedges : public GenContext<ThreadPool::TPHandle&>  {
+  ECBackend *ec;
+  explicit CheckReadHedges(ECBackend *ec) : ec(ec) {}
+  void finish(ThreadPool::TPHandle &handle) override {
+    ec->check_read_hedges();
+  }
+};
+
+void ECBackend::maybe_schedule_read_hedge(ReadOp &rop)
+{
+  if (read_hedge_scheduled || !rop.op || rop.for_recovery ||
+      rop.do_redundant_reads)
+    return;
+  double delay = cct->_conf->get_val<double>("osd_ec_read_hedge_delay");
+  if (delay <= 0)
+    return;
+  schedule_read_hedge_check(rop.op, delay);
+}
+
+void ECBackend::schedule_read_hedge_check(OpRequestRef op, double delay)
+{
+  dout(20) << __func__ << ": in " << delay << dendl;
+  read_hedge_scheduled = true;
+  get_parent()->schedule_op_work_after(
+    op,
+    get_parent()->bless_unlocked_gencontext(new CheckReadHedges(this)),
+    delay);
+}
+
+void ECBackend::check_read_hedges()
+{
+  read_hedge_scheduled = false;
+  double delay = cct->_conf->get_val<double>("osd_ec_read_hedge_delay");
+  if (delay <= 0)
+    return;
+  auto now = ceph::mono_clock::now();
+  auto cutoff = now - ceph::make_timespan(delay);
+  ReadOp *oldest = nullptr;
+  for (auto &&i: tid_to_read_map) {
+    ReadOp &rop = i.second;
+    if (!rop.op || rop.for_recovery || rop.do_redundant_reads || rop.hedged)
+      continue;
+    if (rop.start <= cutoff) {
+      rop.hedged = true;
+      hedge_read_op(rop);
+    } else if (!oldest || rop.start < oldest->start) {
+      oldest = &rop;
+    }
+  }
+  if (oldest) {
+    // check again once the oldest read still pending is due
+    schedule_read_hedge_check(
+      oldest->op,
+      std::chrono::duration<double>(oldest->start - cutoff).count());
+  }
+}
+
+void ECBackend::hedge_read_op(ReadOp &rop)
+{
+  if (rop.do_redundant_reads || rop.in_progress.empty())
+    return;
+
+  map<hobject_t, read_request_t> for_read_op;
+  for (auto &&i: rop.to_read) {
+    // skip shards with a sub read of this op still in flight, each shard
+    // may only have one outstanding per tid
+    set<int> already_read;
+    for (auto &&j: rop.obj_to_source[i.first])
+      already_read.insert(j.shard);
+    for (auto &&j: rop.in_progress)
+      already_read.insert(j.shard);
+    map<pg_shard_t, vector<pair<int, int>>> shards;
+    int r = get_remaining_shards(i.first, already_read, &shards, false);
+    if (r < 0 || shards.empty())
+      continue;
+    for_read_op.insert(
+      make_pair(
+	i.first,
+	read_request_t(
+	  i.second.to_read,
+	  shards,
+	  false,
+	  nullptr)));
+  }
+  if (for_read_op.empty())
+    return;
+
+  dout(10) << __func__ << ": hedging " << rop << " waiting on "
+	   << rop.in_progress << dendl;
+  rop.trace.event("ec read hedged");
+  rop.do_redundant_reads = true;
+  do_read_op(rop, for_read_op);
+}
+
 void ECBackend::filter_read_op(
   const OSDMapRef& osdmap,
   ReadOp &op)
@@ -1380,6 +1485,7 @@ void ECBackend::on_change()
   tid_to_read_map.clear();
   in_progress_client_reads.clear();
   shard_to_read_map.clear();
+  read_hedge_scheduled = false;
   clear_recovery_state();
 }
 
@@ -1600,10 +1706,19 @@ void ECBackend::start_read_op(
     op.trace = _op->pg_trace;
     op.trace.event("start ec read");
   }
+  op.start = ceph::mono_clock::now();
   do_read_op(op);
+  maybe_schedule_read_hedge(op);
 }
 
 void ECBackend::do_read_op(ReadOp &op)
+{
+  do_read_op(op, op.to_read);
+}
+
+void ECBackend::do_read_op(
+  ReadOp &op,
+  const map<hobject_t, read_request_t> &to_read)
 {
   int priority = op.priority;
   ceph_tid_t tid = op.tid;
@@ -1611,8 +1726,8 @@ void ECBackend::do_read_op(ReadOp &op)
   dout(10) << __func__ << ": starting read " << op << dendl;
 
   map<pg_shard_t, ECSubRead> messages;
-  for (map<hobject_t, read_request_t>::iterator i = op.to_read.begin();
-       i != op.to_read.end();
+  for (map<hobject_t, read_request_t>::const_iterator i = to_read.begin();
+       i != to_read.end();
        ++i) {
     bool need_attrs = i->second.want_attrs;
 
@@ -2061,7 +2176,8 @@ void ECBackend::objects_read_async(
   const list<pair<boost::tuple<uint64_t, uint64_t, uint32_t>,
              pair<bufferlist*, Context*> > > &to_read,
   Context *on_complete,
-  bool fast_read)
+  bool fast_read,
+  OpRequestRef op)
 {
   map<hobject_t,std::list<boost::tuple<uint64_t, uint64_t, uint32_t> > >
     reads;
@@ -2082,14 +2198,30 @@ void ECBackend::objects_read_async(
   }
 
   if (!es.empty()) {
+    // Pass the tightest unaligned extent within each stripe aligned
+    // range so that objects_read_and_reconstruct can skip the data
+    // shards the client did not ask for.
     auto &offsets = reads[hoid];
     for (auto j = es.begin();
 	 j != es.end();
 	 ++j) {
+      uint64_t start = j.get_start() + j.get_len();
+      uint64_t end = j.get_start();
+      for (auto &&i: to_read) {
+	uint64_t off = i.first.get<0>();
+	if (off < j.get_start() || off >= j.get_start() + j.get_len())
+	  continue;
+	start = std::min(start, off);
+	end = std::max(end, off + i.first.get<1>());
+      }
+      if (start >= end) {
+	start = j.get_start();
+	end = j.get_start() + j.get_len();
+      }
       offsets.push_back(
 	boost::make_tuple(
-	  j.get_start(),
-	  j.get_len(),
+	  start,
+	  end - start,
 	  flags));
     }
   }
@@ -2168,7 +2300,8 @@ void ECBackend::objects_read_async(
 	cb(this,
 	   hoid,
 	   to_read,
-	   on_complete)));
+	   on_complete)),
+    op);
 }
 
 struct CallClientContexts :
@@ -2177,12 +2310,15 @@ struct CallClientContexts :
   ECBackend *ec;
   ECBackend::ClientAsyncReadStatus *status;
   list<boost::tuple<uint64_t, uint64_t, uint32_t> > to_read;
+  set<int> want_to_read; ///< empty if every data shard was read
   CallClientContexts(
     hobject_t hoid,
     ECBackend *ec,
     ECBackend::ClientAsyncReadStatus *status,
-    const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read)
-    : hoid(hoid), ec(ec), status(status), to_read(to_read) {}
+    const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+    const set<int> &want_to_read)
+    : hoid(hoid), ec(ec), status(status), to_read(to_read),
+      want_to_read(want_to_read) {}
   void finish(pair<RecoveryMessages *, ECBackend::read_result_t &> &in) override {
     ECBackend::read_result_t &res = in.second;
     extent_map result;
@@ -2197,28 +2333,38 @@ struct CallClientContexts :
       assert(res.returned.front().get<0>() == adjusted.first &&
 	     res.returned.front().get<1>() == adjusted.second);
       map<int, bufferlist> to_decode;
-      bufferlist bl;
       for (map<pg_shard_t, bufferlist>::iterator j =
 	     res.returned.front().get<2>().begin();
 	   j != res.returned.front().get<2>().end();
 	   ++j) {
 	to_decode[j->first.shard].claim(j->second);
       }
-      int r = ECUtil::decode(
-	ec->sinfo,
-	ec->ec_impl,
-	to_decode,
-	&bl);
-      if (r < 0) {
-        res.r = r;
-        goto out;
-      }
       bufferlist trimmed;
-      trimmed.substr_of(
-	bl,
-	read.get<0>() - adjusted.first,
-	std::min(read.get<1>(),
-	    bl.length() - (read.get<0>() - adjusted.first)));
+      if (!want_to_read.empty()) {
+	int r = partial_decode(read, adjusted.first, to_decode, &trimmed);
+	if (r < 0) {
+	  res.r = r;
+	  goto out;
+	}
+      } else {
+	bufferlist bl;
+	int r = ECUtil::decode(
+	  ec->sinfo,
+	  ec->ec_impl,
+	  to_decode,
+	  &bl);
+	if (r < 0) {
+	  res.r = r;
+	  goto out;
+	}
+	if (read.get<0>() - adjusted.first < bl.length()) {
+	  trimmed.substr_of(
+	    bl,
+	    read.get<0>() - adjusted.first,
+	    std::min(read.get<1>(),
+		bl.length() - (read.get<0>() - adjusted.first)));
+	}
+      }
       result.insert(
 	read.get<0>(), trimmed.length(), std::move(trimmed));
       res.returned.pop_front();
@@ -2227,6 +2373,28 @@ out:
     status->complete_object(hoid, res.r, std::move(result));
     ec->kick_reads();
   }
+
+  /// decode just the shards in want_to_read and gather the logical
+  /// extent read from them, starting at stripe offset stripe_off
+  int partial_decode(
+    const boost::tuple<uint64_t, uint64_t, uint32_t> &read,
+    uint64_t stripe_off,
+    map<int, bufferlist> &to_decode,
+    bufferlist *out) {
+    map<int, bufferlist> decoded;
+    map<int, bufferlist*> decoded_ptrs;
+    for (auto i: want_to_read) {
+      decoded_ptrs[i] = &decoded[i];
+    }
+    int r = ECUtil::decode(ec->sinfo, ec->ec_impl, to_decode, decoded_ptrs);
+    if (r < 0)
+      return r;
+
+    ECUtil::gather_extent(
+      ec->sinfo, ec->ec_impl->get_chunk_mapping(), decoded, stripe_off,
+      read.get<0>(), read.get<1>(), out);
+    return 0;
+  }
 };
 
 void ECBackend::objects_read_and_reconstruct(
@@ -2234,7 +2402,8 @@ void ECBackend::objects_read_and_reconstruct(
     std::list<boost::tuple<uint64_t, uint64_t, uint32_t> >
   > &reads,
   bool fast_read,
-  GenContextURef<map<hobject_t,pair<int, extent_map> > &&> &&func)
+  GenContextURef<map<hobject_t,pair<int, extent_map> > &&> &&func,
+  OpRequestRef op)
 {
   in_progress_client_reads.emplace_back(
     reads.size(), std::move(func));
@@ -2243,15 +2412,33 @@ void ECBackend::objects_read_and_reconstruct(
     return;
   }
 
-  set<int> want_to_read;
-  get_want_to_read_shards(&want_to_read);
-    
+  set<int> all_data_shards;
+  get_want_to_read_shards(&all_data_shards);
+  bool partial_reads = cct->_conf->get_val<bool>("osd_ec_partial_reads");
+
   map<hobject_t, read_request_t> for_read_op;
   for (auto &&to_read: reads) {
+    // the shards only see stripe aligned extents
+    list<boost::tuple<uint64_t, uint64_t, uint32_t> > aligned;
+    for (auto &&extent: to_read.second) {
+      pair<uint64_t, uint64_t> bounds = sinfo.offset_len_to_stripe_bounds(
+	make_pair(extent.get<0>(), extent.get<1>()));
+      aligned.push_back(
+	boost::make_tuple(bounds.first, bounds.second, extent.get<2>()));
+    }
+
+    set<int> want_to_read;
+    if (partial_reads) {
+      get_want_to_read_shards(to_read.second, &want_to_read);
+    }
+    if (want_to_read.empty() || want_to_read == all_data_shards) {
+      want_to_read.clear();
+    }
+
     map<pg_shard_t, vector<pair<int, int>>> shards;
     int r = get_min_avail_to_read_shards(
       to_read.first,
-      want_to_read,
+      want_to_read.empty() ? all_data_shards : want_to_read,
       false,
       fast_read,
       &shards);
@@ -2261,21 +2448,23 @@ void ECBackend::objects_read_and_reconstruct(
       to_read.first,
       this,
       &(in_progress_client_reads.back()),
-      to_read.second);
+      to_read.second,
+      want_to_read);
     for_read_op.insert(
       make_pair(
 	to_read.first,
 	read_request_t(
-	  to_read.second,
+	  aligned,
 	  shards,
 	  false,
+	  want_to_read,
 	  c)));
   }
 
   start_read_op(
     CEPH_MSG_PRIO_DEFAULT,
     for_read_op,
-    OpRequestRef(),
+    op,
     fast_read, false);
   return;
 }
@@ -2304,6 +2493,7 @@ int ECBackend::send_all_remaining_reads(
     rop.to_read.find(hoid)->second.to_read;
   GenContext<pair<RecoveryMessages *, read_result_t& > &> *c =
     rop.to_read.find(hoid)->second.cb;
+  set<int> want_to_read = rop.to_read.find(hoid)->second.want_to_read;
 
   map<hobject_t, read_request_t> for_read_op;
   for_read_op.insert(
@@ -2313,6 +2503,7 @@ int ECBackend::send_all_remaining_reads(
 	offsets,
 	shards,
 	false,
+	want_to_read,
 	c)));
 
   rop.to_read.swap(for_read_op);
@@ -140,7 +140,8 @@ public:
     const map<hobject_t, std::list<boost::tuple<uint64_t, uint64_t, uint32_t> >
     > &reads,
     bool fast_read,
-    GenContextURef<map<hobject_t,pair<int, extent_map> > &&> &&func);
+    GenContextURef<map<hobject_t,pair<int, extent_map> > &&> &&func,
+    OpRequestRef op = OpRequestRef());
 
   friend struct CallClientContexts;
   struct ClientAsyncReadStatus {
@@ -173,7 +174,8 @@ public:
     const list<pair<boost::tuple<uint64_t, uint64_t, uint32_t>,
 		    pair<bufferlist*, Context*> > > &to_read,
     Context *on_complete,
-    bool fast_read = false) override;
+    bool fast_read = false,
+    OpRequestRef op = OpRequestRef()) override;
 
   template <typename Func>
   void objects_read_async_no_cache(
@@ -215,6 +217,21 @@ private:
       want_to_read->insert(chunk);
     }
   }
+  /// data shards holding the given logical extents
+  void get_want_to_read_shards(
+    const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &extents,
+    set<int> *want_to_read) const {
+    set<int> chunks;
+    for (auto &&extent: extents) {
+      sinfo.offset_len_to_data_chunks(
+	make_pair(extent.get<0>(), extent.get<1>()), &chunks);
+    }
+    const vector<int> &chunk_mapping = ec_impl->get_chunk_mapping();
+    for (auto i: chunks) {
+      int chunk = (int)chunk_mapping.size() > i ? chunk_mapping[i] : i;
+      want_to_read->insert(chunk);
+    }
+  }
 
   /**
    * Recovery
@@ -352,6 +369,9 @@ public:
     const list<boost::tuple<uint64_t, uint64_t, uint32_t> > to_read;
     const map<pg_shard_t, vector<pair<int, int>>> need;
     const bool want_attrs;
+    // shards which must be decodable for the read to complete, empty
+    // meaning all of the data shards
+    const set<int> want_to_read;
     GenContext<pair<RecoveryMessages *, read_result_t& > &> *cb;
     read_request_t(
       const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
@@ -360,6 +380,14 @@ public:
       GenContext<pair<RecoveryMessages *, read_result_t& > &> *cb)
       : to_read(to_read), need(need), want_attrs(want_attrs),
 	cb(cb) {}
+    read_request_t(
+      const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+      const map<pg_shard_t, vector<pair<int, int>>> &need,
+      bool want_attrs,
+      const set<int> &want_to_read,
+      GenContext<pair<RecoveryMessages *, read_result_t& > &> *cb)
+      : to_read(to_read), need(need), want_attrs(want_attrs),
+	want_to_read(want_to_read), cb(cb) {}
   };
   friend ostream &operator<<(ostream &lhs, const read_request_t &rhs);
 
@@ -374,6 +402,10 @@ public:
     // True if reading for recovery which could possibly reading only a subset
     // of the available shards.
     bool for_recovery;
+    // when the read was started and whether it has been considered for
+    // hedging yet, see check_read_hedges
+    ceph::mono_time start;
+    bool hedged = false;
 
     ZTracer::Trace trace;
 
@@ -412,6 +444,7 @@ public:
     ReadOp(ReadOp &&) = default;
   };
   friend struct FinishReadOp;
+  friend struct CheckReadHedges;
   void filter_read_op(
     const OSDMapRef& osdmap,
     ReadOp &op);
@@ -426,10 +459,33 @@ public:
     bool do_redundant_reads, bool for_recovery);
 
   void do_read_op(ReadOp &rop);
+  void do_read_op(
+    ReadOp &rop,
+    const map<hobject_t, read_request_t> &to_read);
   int send_all_remaining_reads(
     const hobject_t &hoid,
     ReadOp &rop);
 
+  /**
+   * Read hedging
+   *
+   * A client read normally waits on the minimum set of shards needed to
+   * satisfy it.  If it is still outstanding after
+   * osd_ec_read_hedge_delay, hedge_read_op sends the same reads to every
+   * remaining shard and turns the op into a redundant read so that it
+   * completes as soon as any decodable set has replied.
+   *
+   * A pg keeps at most one check armed, due when its oldest unhedged
+   * client read reaches the delay; reads that complete before then
+   * never cost a timer event.  The check runs on the op path of the
+   * client op that armed it.
+   */
+  bool read_hedge_scheduled = false;
+  void maybe_schedule_read_hedge(ReadOp &rop);
+  void schedule_read_hedge_check(OpRequestRef op, double delay);
+  void check_read_hedges();
+  void hedge_read_op(ReadOp &rop);
+
 
   /**
    * Client writes
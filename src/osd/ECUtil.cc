@@ -117,6 +117,37 @@ int ECUtil::decode(
   return 0;
 }
 
+void ECUtil::gather_extent(
+  const stripe_info_t &sinfo,
+  const vector<int> &chunk_mapping,
+  map<int, bufferlist> &decoded,
+  uint64_t stripe_off,
+  uint64_t off,
+  uint64_t len,
+  bufferlist *out) {
+  const uint64_t stripe_width = sinfo.get_stripe_width();
+  const uint64_t chunk_size = sinfo.get_chunk_size();
+  uint64_t end = off + len;
+  assert(off >= stripe_off);
+  while (off < end) {
+    int chunk = (off % stripe_width) / chunk_size;
+    int shard = (int)chunk_mapping.size() > chunk ?
+      chunk_mapping[chunk] : chunk;
+    assert(decoded.count(shard));
+    bufferlist &src = decoded[shard];
+    uint64_t src_off = ((off - stripe_off) / stripe_width) * chunk_size +
+      off % chunk_size;
+    if (src_off >= src.length())
+      break;  // short read at the end of the object
+    uint64_t piece_len = std::min(end - off, chunk_size - off % chunk_size);
+    piece_len = std::min<uint64_t>(piece_len, src.length() - src_off);
+    bufferlist piece;
+    piece.substr_of(src, src_off, piece_len);
+    out->claim_append(piece);
+    off += piece_len;
+  }
+}
+
 int ECUtil::encode(
   const stripe_info_t &sinfo,
   ErasureCodeInterfaceRef &ec_impl,
@@ -77,6 +77,20 @@ public:
       (in.first - off) + in.second);
     return std::make_pair(off, len);
   }
+  /// insert the (unmapped) data chunk indexes covered by a logical extent
+  void offset_len_to_data_chunks(
+    std::pair<uint64_t, uint64_t> in,
+    std::set<int> *chunks) const {
+    if (in.second == 0)
+      return;
+    const uint64_t stripe_size = stripe_width / chunk_size;
+    uint64_t first = in.first / chunk_size;
+    uint64_t last = (in.first + in.second - 1) / chunk_size;
+    if (last - first + 1 >= stripe_size)
+      last = first + stripe_size - 1;
+    for (uint64_t i = first; i <= last; ++i)
+      chunks->insert(i % stripe_size);
+  }
 };
 
 int decode(
@@ -91,6 +105,20 @@ int decode(
   std::map<int, bufferlist> &to_decode,
   std::map<int, bufferlist*> &out);
 
+/**
+ * gather the logical extent [off, off + len) out of the decoded data
+ * shards of the stripes starting at stripe_off; chunk_mapping maps data
+ * chunk indexes to shards as ErasureCodeInterface::get_chunk_mapping does
+ */
+void gather_extent(
+  const stripe_info_t &sinfo,
+  const std::vector<int> &chunk_mapping,
+  std::map<int, bufferlist> &decoded,
+  uint64_t stripe_off,
+  uint64_t off,
+  uint64_t len,
+  bufferlist *out);
+
 int encode(
   const stripe_info_t &sinfo,
   ErasureCodeInterfaceRef &ec_impl,
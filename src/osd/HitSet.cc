@@ -37,6 +37,10 @@ HitSet::HitSet(const HitSet::Params& params)
     impl.reset(new ExplicitObjectHitSet(static_cast<ExplicitObjectHitSet::Params*>(params.impl.get())));
     break;
 
+  case TYPE_COUNT_MIN:
+    impl.reset(new CountMinHitSet(static_cast<CountMinHitSet::Params*>(params.impl.get())));
+    break;
+
   default:
     assert (0 == "unknown HitSet type");
   }
@@ -71,6 +75,9 @@ void HitSet::decode(bufferlist::iterator &bl)
   case TYPE_BLOOM:
     impl.reset(new BloomHitSet);
     break;
+  case TYPE_COUNT_MIN:
+    impl.reset(new CountMinHitSet);
+    break;
   case TYPE_NONE:
     impl.reset(NULL);
     break;
@@ -105,6 +112,10 @@ void HitSet::generate_test_instances(list<HitSet*>& o)
   o.back()->insert(hobject_t());
   o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
   o.back()->insert(hobject_t("qwer", "", CEPH_NOSNAP, 456, 1, ""));
+  o.push_back(new HitSet(new CountMinHitSet(10, 3, 1)));
+  o.back()->insert(hobject_t());
+  o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
+  o.back()->insert(hobject_t("qwer", "", CEPH_NOSNAP, 456, 1, ""));
 }
 
 HitSet::Params::Params(const Params& o)
@@ -158,6 +169,9 @@ bool HitSet::Params::create_impl(impl_type_t type)
   case TYPE_BLOOM:
     impl.reset(new BloomHitSet::Params);
     break;
+  case TYPE_COUNT_MIN:
+    impl.reset(new CountMinHitSet::Params);
+    break;
   case TYPE_NONE:
     impl.reset(NULL);
     break;
@@ -203,6 +217,8 @@ void HitSet::Params::generate_test_instances(list<HitSet::Params*>& o)
   loop_hitset_params(ExplicitHashHitSet);
   o.push_back(new Params(new ExplicitObjectHitSet::Params));
   loop_hitset_params(ExplicitObjectHitSet);
+  o.push_back(new Params(new CountMinHitSet::Params));
+  loop_hitset_params(CountMinHitSet);
 }
 
 ostream& operator<<(ostream& out, const HitSet::Params& p) {
@@ -250,3 +266,18 @@ void BloomHitSet::dump(Formatter *f) const {
   bloom.dump(f);
   f->close_section();
 }
+
+void CountMinHitSet::Params::dump(Formatter *f) const {
+  f->dump_unsigned("target_size", target_size);
+  f->dump_unsigned("depth", depth);
+  f->dump_unsigned("seed", seed);
+}
+
+void CountMinHitSet::dump(Formatter *f) const {
+  f->dump_unsigned("width", width);
+  f->dump_unsigned("depth", depth);
+  f->dump_unsigned("seed", seed);
+  f->dump_unsigned("target_size", target_size);
+  f->dump_unsigned("insert_count", count_inserts);
+  f->dump_unsigned("approx_unique_insert_count", count_unique);
+}
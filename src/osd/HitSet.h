@@ -18,6 +18,7 @@
 #include <boost/scoped_ptr.hpp>
 
 #include "include/encoding.h"
+#include "include/hash.h"
 #include "include/unordered_set.h"
 #include "common/bloom_filter.hpp"
 #include "common/hobject.h"
@@ -36,7 +37,8 @@ public:
     TYPE_NONE = 0,
     TYPE_EXPLICIT_HASH = 1,
     TYPE_EXPLICIT_OBJECT = 2,
-    TYPE_BLOOM = 3
+    TYPE_BLOOM = 3,
+    TYPE_COUNT_MIN = 4
   } impl_type_t;
 
   static const char *get_type_name(impl_type_t t) {
@@ -45,6 +47,7 @@ public:
     case TYPE_EXPLICIT_HASH: return "explicit_hash";
     case TYPE_EXPLICIT_OBJECT: return "explicit_object";
     case TYPE_BLOOM: return "bloom";
+    case TYPE_COUNT_MIN: return "count_min";
     default: return "???";
     }
   }
@@ -61,6 +64,11 @@ public:
     virtual bool is_full() const = 0;
     virtual void insert(const hobject_t& o) = 0;
     virtual bool contains(const hobject_t& o) const = 0;
+    /// (estimated) number of inserts of o; sets that only track
+    /// presence report 0 or 1
+    virtual unsigned count(const hobject_t& o) const {
+      return contains(o) ? 1 : 0;
+    }
     virtual unsigned insert_count() const = 0;
     virtual unsigned approx_unique_insert_count() const = 0;
     virtual void encode(bufferlist &bl) const = 0;
@@ -145,6 +153,10 @@ public:
   bool contains(const hobject_t& o) const {
     return impl->contains(o);
   }
+  /// query how many times a hash was inserted
+  unsigned count(const hobject_t& o) const {
+    return impl->count(o);
+  }
 
   unsigned insert_count() const {
     return impl->insert_count();
@@ -450,4 +462,161 @@ public:
 };
 WRITE_CLASS_ENCODER(BloomHitSet)
 
+/**
+ * use a count-min sketch to track how often each object is hit
+ *
+ * Each of depth rows holds width saturating 8-bit counters; an insert
+ * bumps one counter per row and count() reports the smallest of them,
+ * which can overestimate (on collisions) but never underestimate.
+ */
+class CountMinHitSet : public HitSet::Impl {
+  uint32_t width;
+  uint32_t depth;
+  uint64_t seed;
+  uint64_t target_size;
+  uint64_t count_inserts;
+  uint64_t count_unique;   ///< inserts that found a zero estimate
+  std::vector<uint8_t> counters;  ///< depth rows of width counters
+
+  uint32_t slot(const hobject_t& o, uint32_t row) const {
+    static rjhash<uint64_t> H;
+    uint64_t k = ((uint64_t)(seed + row) << 32) | o.get_hash();
+    return row * width + H(k) % width;
+  }
+
+public:
+  HitSet::impl_type_t get_type() const override {
+    return HitSet::TYPE_COUNT_MIN;
+  }
+
+  class Params : public HitSet::Params::Impl {
+  public:
+    HitSet::impl_type_t get_type() const override {
+      return HitSet::TYPE_COUNT_MIN;
+    }
+    HitSet::Impl *get_new_impl() const override {
+      return new CountMinHitSet(this);
+    }
+
+    uint64_t target_size;  ///< number of unique objects we expect
+    uint32_t depth;        ///< number of hash rows
+    uint64_t seed;
+
+    Params() : target_size(0), depth(4), seed(0) {}
+    Params(uint64_t t, uint32_t d, uint64_t s)
+      : target_size(t), depth(d), seed(s) {}
+    ~Params() override {}
+
+    void encode(bufferlist& bl) const override {
+      ENCODE_START(1, 1, bl);
+      encode(target_size, bl);
+      encode(depth, bl);
+      encode(seed, bl);
+      ENCODE_FINISH(bl);
+    }
+    void decode(bufferlist::iterator& bl) override {
+      DECODE_START(1, bl);
+      decode(target_size, bl);
+      decode(depth, bl);
+      decode(seed, bl);
+      DECODE_FINISH(bl);
+    }
+    void dump(Formatter *f) const override;
+    void dump_stream(ostream& o) const override {
+      o << "target_size: " << target_size
+	<< ", depth: " << depth
+	<< ", seed: " << seed;
+    }
+    static void generate_test_instances(list<Params*>& o) {
+      o.push_back(new Params);
+      o.push_back(new Params(300, 3, 99));
+    }
+  };
+
+  CountMinHitSet()
+    : width(0), depth(0), seed(0), target_size(0),
+      count_inserts(0), count_unique(0) {}
+  CountMinHitSet(uint64_t target, uint32_t d, uint64_t s)
+    : width(std::max<uint64_t>(target, 1) * 2),
+      depth(std::max<uint32_t>(d, 1)),
+      seed(s),
+      target_size(target),
+      count_inserts(0), count_unique(0),
+      counters((uint64_t)width * depth) {}
+  explicit CountMinHitSet(const CountMinHitSet::Params *p)
+    : CountMinHitSet(p->target_size, p->depth, p->seed) {}
+
+  HitSet::Impl *clone() const override {
+    return new CountMinHitSet(*this);
+  }
+
+  bool is_full() const override {
+    return target_size && count_unique >= target_size;
+  }
+  void insert(const hobject_t& o) override {
+    if (counters.empty())
+      return;
+    if (count(o) == 0)
+      ++count_unique;
+    for (uint32_t r = 0; r < depth; ++r) {
+      uint8_t &c = counters[slot(o, r)];
+      if (c < UINT8_MAX)
+	++c;
+    }
+    ++count_inserts;
+  }
+  bool contains(const hobject_t& o) const override {
+    return count(o) > 0;
+  }
+  unsigned count(const hobject_t& o) const override {
+    if (counters.empty())
+      return 0;
+    unsigned m = UINT8_MAX;
+    for (uint32_t r = 0; r < depth && m > 0; ++r)
+      m = std::min<unsigned>(m, counters[slot(o, r)]);
+    return m;
+  }
+  unsigned insert_count() const override {
+    return count_inserts;
+  }
+  unsigned approx_unique_insert_count() const override {
+    return count_unique;
+  }
+
+  void encode(bufferlist &bl) const override {
+    ENCODE_START(1, 1, bl);
+    encode(width, bl);
+    encode(depth, bl);
+    encode(seed, bl);
+    encode(target_size, bl);
+    encode(count_inserts, bl);
+    encode(count_unique, bl);
+    encode(counters, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(bufferlist::iterator &bl) override {
+    DECODE_START(1, bl);
+    decode(width, bl);
+    decode(depth, bl);
+    decode(seed, bl);
+    decode(target_size, bl);
+    decode(count_inserts, bl);
+    decode(count_unique, bl);
+    decode(counters, bl);
+    DECODE_FINISH(bl);
+    if (counters.size() != (uint64_t)width * depth)
+      throw buffer::malformed_input("bad CountMinHitSet dimensions");
+  }
+  void dump(Formatter *f) const override;
+  static void generate_test_instances(list<CountMinHitSet*>& o) {
+    o.push_back(new CountMinHitSet);
+    o.push_back(new CountMinHitSet(10, 3, 1));
+    o.back()->insert(hobject_t());
+    o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
+    o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
+    o.back()->insert(hobject_t("qwer", "", CEPH_NOSNAP, 456, 1, ""));
+  }
+};
+WRITE_CLASS_ENCODER(CountMinHitSet)
+
 #endif
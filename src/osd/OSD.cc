@@ -226,6 +226,8 @@ OSDService::OSDService(OSD *osd) :
   recoverystate_perf(osd->recoverystate_perf),
   monc(osd->monc),
   class_handler(osd->class_handler),
+  async_read_wq(osd->async_read_wq),
+  async_read_threads(cct->_conf->get_val<uint64_t>("osd_async_read_threads")),
   osd_max_object_size(*cct->_conf, "osd_max_object_size"),
   osd_skip_data_digest(*cct->_conf, "osd_skip_data_digest"),
   publish_lock("OSDService::publish_lock"),
@@ -267,12 +269,16 @@ OSDService::OSDService(OSD *osd) :
   scrub_sleep_lock("OSDService::scrub_sleep_lock"),
   scrub_sleep_timer(
     osd->client_messenger->cct, scrub_sleep_lock, false /* relax locking */),
+  op_work_lock("OSDService::op_work_lock"),
+  op_work_timer(
+    osd->client_messenger->cct, op_work_lock, false /* relax locking */),
   snap_reserver(cct, &reserver_finisher,
 		cct->_conf->osd_max_trimming_pgs),
   recovery_lock("OSDService::recovery_lock"),
   recovery_ops_active(0),
   recovery_ops_reserved(0),
   recovery_paused(false),
+  recovery_controller(cct),
   map_cache_lock("OSDService::map_cache_lock"),
   map_cache(cct, cct->_conf->osd_map_cache_size),
   map_bl_cache(cct->_conf->osd_map_cache_size),
@@ -424,6 +430,11 @@ void OSDService::shutdown()
     scrub_sleep_timer.shutdown();
   }
 
+  {
+    Mutex::Locker l(op_work_lock);
+    op_work_timer.shutdown();
+  }
+
   osdmap = OSDMapRef();
   next_osdmap = OSDMapRef();
 }
@@ -443,6 +454,7 @@ void OSDService::init()
   agent_timer.init();
   snap_sleep_timer.init();
   scrub_sleep_timer.init();
+  op_work_timer.init();
 
   agent_thread.create("osd_srv_agent");
 
@@ -1421,6 +1433,67 @@ void OSDService::_add_map_inc_bl(epoch_t e, bufferlist& bl)
   map_bl_inc_cache.add(e, bl);
 }
 
+void OSDService::note_map_mapping_delta(const OSDMap::Incremental& inc)
+{
+  // anything feeding crush or the up/acting filters may remap every pg
+  if (inc.fullmap.length() ||
+      inc.crush.length() ||
+      inc.new_max_osd >= 0 ||
+      !inc.new_up_client.empty() ||
+      !inc.new_state.empty() ||
+      !inc.new_weight.empty() ||
+      !inc.new_primary_affinity.empty()) {
+    return;
+  }
+  map_mapping_delta_t delta;
+  for (auto& p : inc.new_pools) {
+    delta.pools.insert(p.first);
+  }
+  for (auto pool : inc.old_pools) {
+    delta.pools.insert(pool);
+  }
+  for (auto& p : inc.new_pg_temp) {
+    delta.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_primary_temp) {
+    delta.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap) {
+    delta.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap_items) {
+    delta.pgs.insert(p.first);
+  }
+  delta.pgs.insert(inc.old_pg_upmap.begin(), inc.old_pg_upmap.end());
+  delta.pgs.insert(inc.old_pg_upmap_items.begin(),
+		   inc.old_pg_upmap_items.end());
+  dout(20) << __func__ << " e" << inc.epoch << " pools " << delta.pools
+	   << " pgs " << delta.pgs.size() << dendl;
+  Mutex::Locker l(map_cache_lock);
+  map_mapping_deltas[inc.epoch] = std::move(delta);
+}
+
+bool OSDService::pg_mapping_unchanged(pg_t pgid, epoch_t from, epoch_t to)
+{
+  Mutex::Locker l(map_cache_lock);
+  auto p = map_mapping_deltas.upper_bound(from);
+  for (epoch_t e = from + 1; e <= to; ++e, ++p) {
+    if (p == map_mapping_deltas.end() ||
+	p->first != e ||
+	p->second.affects(pgid)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void OSDService::trim_map_mapping_deltas(epoch_t oldest)
+{
+  Mutex::Locker l(map_cache_lock);
+  map_mapping_deltas.erase(map_mapping_deltas.begin(),
+			   map_mapping_deltas.lower_bound(oldest));
+}
+
 int OSDService::get_deleted_pool_pg_num(int64_t pool)
 {
   Mutex::Locker l(map_cache_lock);
@@ -1599,6 +1672,23 @@ void OSDService::queue_recovery_context(
       e));
 }
 
+void OSDService::queue_op_context(
+  spg_t pgid,
+  OpRequestRef op,
+  GenContext<ThreadPool::TPHandle&> *c)
+{
+  epoch_t e = get_osdmap_epoch();
+  enqueue_back(
+    OpQueueItem(
+      unique_ptr<OpQueueItem::OpQueueable>(
+	new PGOpContext(pgid, op, c, e)),
+      0,
+      op->get_req()->get_priority(),
+      ceph_clock_now(),
+      op->get_req()->get_source().num(),
+      e));
+}
+
 void OSDService::queue_for_snap_trim(PG *pg)
 {
   dout(10) << "queueing " << *pg << " for snaptrim" << dendl;
@@ -1914,6 +2004,10 @@ OSD::OSD(CephContext *cct_, ObjectStore *store_,
   osd_op_tp(cct, "OSD::osd_op_tp", "tp_osd_tp",
 	    get_num_op_threads()),
   command_tp(cct, "OSD::command_tp", "tp_osd_cmd",  1),
+  async_read_tp(cct, "OSD::async_read_tp", "tp_osd_read",
+		cct->_conf->get_val<uint64_t>("osd_async_read_threads")),
+  async_read_wq("OSD::AsyncReadWQ", cct->_conf->osd_op_thread_timeout,
+		&async_read_tp),
   session_waiting_lock("OSD::session_waiting_lock"),
   osdmap_subscribe_lock("OSD::osdmap_subscribe_lock"),
   heartbeat_lock("OSD::heartbeat_lock"),
@@ -1924,6 +2018,10 @@ OSD::OSD(CephContext *cct_, ObjectStore *store_,
   hb_front_server_messenger(hb_front_serverm),
   hb_back_server_messenger(hb_back_serverm),
   daily_loadavg(0.0),
+  osd_heartbeat_use_data_traffic(*cct->_conf,
+				 "osd_heartbeat_use_data_traffic"),
+  hb_rtt_avg(0),
+  hb_rtt_dev(0),
   heartbeat_thread(this),
   heartbeat_dispatcher(this),
   op_tracker(cct, cct->_conf->osd_enable_op_tracker,
@@ -1956,6 +2054,8 @@ OSD::OSD(CephContext *cct_, ObjectStore *store_,
                                            cct->_conf->osd_op_history_duration);
   op_tracker.set_history_slow_op_size_and_threshold(cct->_conf->osd_op_history_slow_op_size,
                                                     cct->_conf->osd_op_history_slow_op_threshold);
+  op_tracker.set_sample_rate(
+    cct->_conf->get_val<uint64_t>("osd_op_tracker_sample_rate"));
 #ifdef WITH_BLKIN
   std::stringstream ss;
   ss << "osd." << whoami;
@@ -2158,6 +2258,10 @@ will start to track new ops received afterwards.";
     }
 
     f->close_section(); //watchers
+  } else if (admin_command == "dump_recovery_controller") {
+    f->open_object_section("recovery_controller");
+    service.recovery_controller.dump(f);
+    f->close_section();
   } else if (admin_command == "dump_reservations") {
     f->open_object_section("reservations");
     f->open_object_section("local_reservations");
@@ -2375,6 +2479,13 @@ int OSD::get_num_op_threads()
 }
 
 float OSD::get_osd_recovery_sleep()
+{
+  if (service.recovery_controller.is_enabled())
+    return service.recovery_controller.get_sleep();
+  return get_osd_recovery_sleep_conf();
+}
+
+float OSD::get_osd_recovery_sleep_conf()
 {
   if (cct->_conf->osd_recovery_sleep)
     return cct->_conf->osd_recovery_sleep;
@@ -2386,6 +2497,19 @@ float OSD::get_osd_recovery_sleep()
     return cct->_conf->osd_recovery_sleep_hdd;
 }
 
+void OSD::update_recovery_controller()
+{
+  service.recovery_controller.update(cct->_conf->osd_recovery_max_active,
+				     get_osd_recovery_sleep_conf());
+  logger->set(l_osd_recovery_ctl_max_active,
+	      service.recovery_controller.get_max_active());
+  utime_t t;
+  t.set_from_double(service.recovery_controller.get_sleep());
+  logger->tset(l_osd_recovery_ctl_sleep, t);
+  t.set_from_double(service.recovery_controller.get_client_p99());
+  logger->tset(l_osd_recovery_ctl_client_lat, t);
+}
+
 int OSD::init()
 {
   CompatSet initial, diff;
@@ -2608,6 +2732,7 @@ int OSD::init()
 
   osd_op_tp.start();
   command_tp.start();
+  async_read_tp.start();
 
   // start the heartbeat
   heartbeat_thread.create("osd_srv_heartbt");
@@ -2758,6 +2883,11 @@ void OSD::final_init()
 				     asok_hook,
 				     "show recovery reservations");
   assert(r == 0);
+  r = admin_socket->register_command("dump_recovery_controller",
+				     "dump_recovery_controller",
+				     asok_hook,
+				     "show recovery controller state");
+  assert(r == 0);
   r = admin_socket->register_command("get_latest_osdmap", "get_latest_osdmap",
 				     asok_hook,
 				     "force osd to update the latest map from "
@@ -3205,6 +3335,16 @@ void OSD::create_logger()
   osd_plb.add_u64_counter(
     l_osd_pg_biginfo, "osd_pg_biginfo", "PG updated its biginfo attr");
 
+  osd_plb.add_u64(
+    l_osd_recovery_ctl_max_active, "recovery_ctl_max_active",
+    "Recovery ops allowed in flight by the recovery controller");
+  osd_plb.add_time(
+    l_osd_recovery_ctl_sleep, "recovery_ctl_sleep",
+    "Recovery sleep chosen by the recovery controller");
+  osd_plb.add_time(
+    l_osd_recovery_ctl_client_lat, "recovery_ctl_client_lat",
+    "Client op p99 latency seen by the recovery controller");
+
   logger = osd_plb.create_perf_counters();
   cct->get_perfcounters_collection()->add(logger);
 }
@@ -3311,6 +3451,7 @@ int OSD::shutdown()
   cct->get_admin_socket()->unregister_command("dump_blacklist");
   cct->get_admin_socket()->unregister_command("dump_watchers");
   cct->get_admin_socket()->unregister_command("dump_reservations");
+  cct->get_admin_socket()->unregister_command("dump_recovery_controller");
   cct->get_admin_socket()->unregister_command("get_latest_osdmap");
   cct->get_admin_socket()->unregister_command("heap");
   cct->get_admin_socket()->unregister_command("set_heap_property");
@@ -3356,6 +3497,10 @@ int OSD::shutdown()
   command_tp.stop();
   dout(10) << "command tp stopped" << dendl;
 
+  async_read_tp.drain();
+  async_read_tp.stop();
+  dout(10) << "async read tp stopped" << dendl;
+
   dout(10) << "stopping agent" << dendl;
   service.agent_stop();
 
@@ -4572,6 +4717,7 @@ void OSD::handle_osd_ping(MOSDPing *m)
 		   << dendl;
 	  i->second.last_rx_front = m->stamp;
 	}
+	_note_heartbeat_rtt(ceph_clock_now() - m->stamp);
 
         utime_t cutoff = ceph_clock_now();
         cutoff -= cct->_conf->osd_heartbeat_grace;
@@ -4627,7 +4773,7 @@ void OSD::heartbeat_entry()
   while (!heartbeat_stop) {
     heartbeat();
 
-    double wait = .5 + ((float)(rand() % 10)/10.0) * (float)cct->_conf->osd_heartbeat_interval;
+    double wait = .5 + ((float)(rand() % 10)/10.0) * _get_heartbeat_interval();
     utime_t w;
     w.set_from_double(wait);
     dout(30) << "heartbeat_entry sleeping for " << wait << dendl;
@@ -4641,6 +4787,7 @@ void OSD::heartbeat_entry()
 void OSD::heartbeat_check()
 {
   assert(heartbeat_lock.is_locked());
+  _apply_peer_data_rx();
   utime_t now = ceph_clock_now();
 
   // check for heartbeat replies (move me elsewhere?)
@@ -4682,6 +4829,75 @@ void OSD::heartbeat_check()
   }
 }
 
+void OSD::note_peer_data_rx(int peer)
+{
+  utime_t now = ceph_clock_now();
+  std::lock_guard<ceph::spinlock> l(peer_data_rx_lock);
+  peer_data_rx[peer] = now;
+}
+
+/*
+ * fold data replies seen since the last call into the back-side
+ * liveness of our heartbeat peers.  a peer that stops replying stops
+ * advancing last_rx_back just as if it stopped answering pings, so
+ * failure detection is unchanged.
+ */
+void OSD::_apply_peer_data_rx()
+{
+  assert(heartbeat_lock.is_locked());
+  map<int, utime_t> rx;
+  {
+    std::lock_guard<ceph::spinlock> l(peer_data_rx_lock);
+    rx.swap(peer_data_rx);
+  }
+  for (auto& p : rx) {
+    auto i = heartbeat_peers.find(p.first);
+    if (i == heartbeat_peers.end() ||
+	i->second.first_tx == utime_t() ||
+	p.second < i->second.first_tx ||
+	p.second <= i->second.last_rx_back)
+      continue;
+    i->second.last_rx_back = p.second;
+    if (i->second.con_front == NULL)
+      i->second.last_rx_front = p.second;
+  }
+}
+
+void OSD::_note_heartbeat_rtt(utime_t rtt)
+{
+  assert(heartbeat_lock.is_locked());
+  double r = rtt;
+  if (r < 0)
+    return;
+  // smoothed the way tcp does (rfc 6298)
+  if (hb_rtt_avg == 0) {
+    hb_rtt_avg = r;
+    hb_rtt_dev = r / 2;
+  } else {
+    hb_rtt_dev = .75 * hb_rtt_dev + .25 * fabs(hb_rtt_avg - r);
+    hb_rtt_avg = .875 * hb_rtt_avg + .125 * r;
+  }
+}
+
+/*
+ * with osd_heartbeat_interval_max set, stretch the ping interval while
+ * round trips are steady and fall back to osd_heartbeat_interval as
+ * they get noisy.  the grace period is untouched, and the interval is
+ * kept to a third of it so a single lost ping cannot fail a peer.
+ */
+double OSD::_get_heartbeat_interval()
+{
+  assert(heartbeat_lock.is_locked());
+  double base = cct->_conf->osd_heartbeat_interval;
+  double max = std::min(
+    cct->_conf->get_val<double>("osd_heartbeat_interval_max"),
+    (double)cct->_conf->osd_heartbeat_grace / 3);
+  if (max <= base || hb_rtt_avg <= 0)
+    return base;
+  double steady = std::max(0.0, 1.0 - hb_rtt_dev / hb_rtt_avg);
+  return base + (max - base) * steady;
+}
+
 void OSD::heartbeat()
 {
   dout(30) << "heartbeat" << dendl;
@@ -4715,6 +4931,9 @@ void OSD::heartbeat()
   dout(5) << "heartbeat: " << service.get_osd_stat() << dendl;
 
   utime_t now = ceph_clock_now();
+  _apply_peer_data_rx();
+  utime_t data_cutoff = now;
+  data_cutoff -= cct->_conf->osd_heartbeat_interval;
 
   // send heartbeats
   for (map<int,HeartbeatInfo>::iterator i = heartbeat_peers.begin();
@@ -4724,11 +4943,19 @@ void OSD::heartbeat()
     i->second.last_tx = now;
     if (i->second.first_tx == utime_t())
       i->second.first_tx = now;
-    dout(30) << "heartbeat sending ping to osd." << peer << dendl;
-    i->second.con_back->send_message(new MOSDPing(monc->get_fsid(),
-					  service.get_osdmap_epoch(),
-					  MOSDPing::PING, now,
-					  cct->_conf->osd_heartbeat_min_size));
+    if (osd_heartbeat_use_data_traffic &&
+	i->second.con_front &&
+	i->second.last_rx_back > data_cutoff) {
+      // recent replication replies already show the back side is alive
+      dout(30) << "heartbeat skipping back ping to osd." << peer
+	       << ", data rx at " << i->second.last_rx_back << dendl;
+    } else {
+      dout(30) << "heartbeat sending ping to osd." << peer << dendl;
+      i->second.con_back->send_message(new MOSDPing(monc->get_fsid(),
+					    service.get_osdmap_epoch(),
+					    MOSDPing::PING, now,
+					    cct->_conf->osd_heartbeat_min_size));
+    }
 
     if (i->second.con_front)
       i->second.con_front->send_message(new MOSDPing(monc->get_fsid(),
@@ -4887,6 +5114,7 @@ void OSD::tick_without_osd_lock()
   }
 
   mgrc.update_daemon_health(get_health_metrics());
+  update_recovery_controller();
   service.kick_recovery_queue();
   tick_timer_without_osd_lock.add_event_after(OSD_TICK_INTERVAL, new C_Tick_WithoutOSDLock(this));
 }
@@ -6531,6 +6759,15 @@ void OSD::ms_fast_dispatch(Message *m)
 void OSD::ms_fast_preprocess(Message *m)
 {
   if (m->get_connection()->get_peer_type() == CEPH_ENTITY_TYPE_OSD) {
+    switch (m->get_type()) {
+    case MSG_OSD_REPOPREPLY:
+    case MSG_OSD_EC_WRITE_REPLY:
+    case MSG_OSD_EC_READ_REPLY:
+    case MSG_OSD_PG_PUSH_REPLY:
+      if (osd_heartbeat_use_data_traffic)
+	note_peer_data_rx(m->get_source().num());
+      break;
+    }
     if (m->get_type() == CEPH_MSG_OSD_MAP) {
       MOSDMap *mm = static_cast<MOSDMap*>(m);
       Session *s = static_cast<Session*>(m->get_connection()->get_priv());
@@ -7142,6 +7379,7 @@ void OSD::trim_maps(epoch_t oldest, int nreceived, bool skip_maps)
     int tr = store->queue_transaction(service.meta_ch, std::move(t), nullptr);
     assert(tr == 0);
   }
+  service.trim_map_mapping_deltas(superblock.oldest_map);
   // we should not remove the cached maps
   assert(min <= service.map_cache.cached_key_lower_bound());
 }
@@ -7336,6 +7574,7 @@ void OSD::handle_osd_map(MOSDMap *m)
 	break;
       }
       got_full_map(e);
+      service.note_map_mapping_delta(inc);
 
       ghobject_t fulloid = get_osdmap_pobject_name(e);
       t.write(coll_t::meta(), fulloid, 0, fbl.length(), fbl);
@@ -7793,6 +8032,11 @@ void OSD::advance_pg(
   OSDMapRef lastmap = pg->get_osdmap();
   assert(lastmap->get_epoch() < osd_epoch);
   set<PGRef> new_pgs;  // any split children
+  const bool reuse_mapping =
+    cct->_conf->get_val<bool>("osd_advance_pg_reuse_mapping");
+  vector<int> newup, newacting;
+  int up_primary = -1, acting_primary = -1;
+  epoch_t mapped_epoch = 0;  // epoch newup/newacting were computed for
   for (epoch_t next_epoch = pg->get_osdmap_epoch() + 1;
        next_epoch <= osd_epoch;
        ++next_epoch) {
@@ -7802,12 +8046,20 @@ void OSD::advance_pg(
       continue;
     }
 
-    vector<int> newup, newacting;
-    int up_primary, acting_primary;
-    nextmap->pg_to_up_acting_osds(
-      pg->pg_id.pgid,
-      &newup, &up_primary,
-      &newacting, &acting_primary);
+    // during map storms most epochs only carry up_thru, pg_temp and
+    // similar changes for other pgs; skip the crush calculation for them
+    if (!reuse_mapping ||
+	!mapped_epoch ||
+	!service.pg_mapping_unchanged(pg->pg_id.pgid, mapped_epoch,
+				      next_epoch)) {
+      newup.clear();
+      newacting.clear();
+      nextmap->pg_to_up_acting_osds(
+	pg->pg_id.pgid,
+	&newup, &up_primary,
+	&newacting, &acting_primary);
+    }
+    mapped_epoch = next_epoch;
     pg->handle_advance_map(
       nextmap, lastmap, newup, up_primary,
       newacting, acting_primary, rctx);
@@ -8665,7 +8917,7 @@ bool OSDService::_recover_now(uint64_t *available_pushes)
     return false;
   }
 
-  uint64_t max = cct->_conf->osd_recovery_max_active;
+  uint64_t max = _get_recovery_max_active();
   if (max <= recovery_ops_active + recovery_ops_reserved) {
     dout(15) << __func__ << " active " << recovery_ops_active
 	     << " + reserved " << recovery_ops_reserved
@@ -8679,6 +8931,13 @@ bool OSDService::_recover_now(uint64_t *available_pushes)
   return true;
 }
 
+uint64_t OSDService::_get_recovery_max_active()
+{
+  if (recovery_controller.is_enabled())
+    return recovery_controller.get_max_active();
+  return cct->_conf->osd_recovery_max_active;
+}
+
 void OSD::do_recovery(
   PG *pg, epoch_t queued, uint64_t reserved_pushes,
   ThreadPool::TPHandle &handle)
@@ -8758,7 +9017,7 @@ void OSDService::start_recovery_op(PG *pg, const hobject_t& soid)
   Mutex::Locker l(recovery_lock);
   dout(10) << "start_recovery_op " << *pg << " " << soid
 	   << " (" << recovery_ops_active << "/"
-	   << cct->_conf->osd_recovery_max_active << " rops)"
+	   << _get_recovery_max_active() << " rops)"
 	   << dendl;
   recovery_ops_active++;
 
@@ -8774,7 +9033,7 @@ void OSDService::finish_recovery_op(PG *pg, const hobject_t& soid, bool dequeue)
   Mutex::Locker l(recovery_lock);
   dout(10) << "finish_recovery_op " << *pg << " " << soid
 	   << " dequeue=" << dequeue
-	   << " (" << recovery_ops_active << "/" << cct->_conf->osd_recovery_max_active << " rops)"
+	   << " (" << recovery_ops_active << "/" << _get_recovery_max_active() << " rops)"
 	   << dendl;
 
   // adjust count
@@ -8984,6 +9243,7 @@ const char** OSD::get_tracked_conf_keys() const
     "osd_op_history_slow_op_size",
     "osd_op_history_slow_op_threshold",
     "osd_enable_op_tracker",
+    "osd_op_tracker_sample_rate",
     "osd_map_cache_size",
     "osd_pg_epoch_max_lag_factor",
     "osd_pg_epoch_persisted_max_stale",
@@ -9042,6 +9302,10 @@ void OSD::handle_conf_change(const struct md_config_t *conf,
   if (changed.count("osd_enable_op_tracker")) {
       op_tracker.set_tracking(cct->_conf->osd_enable_op_tracker);
   }
+  if (changed.count("osd_op_tracker_sample_rate")) {
+    op_tracker.set_sample_rate(
+      cct->_conf->get_val<uint64_t>("osd_op_tracker_sample_rate"));
+  }
   if (changed.count("osd_map_cache_size")) {
     service.map_cache.set_size(cct->_conf->osd_map_cache_size);
     service.map_bl_cache.set_size(cct->_conf->osd_map_cache_size);
@@ -9142,7 +9406,8 @@ void OSD::get_latest_osdmap()
 
 // --------------------------------
 
-int OSD::init_op_flags(OpRequestRef& op)
+int OSD::init_op_flags(OpRequestRef& op,
+			ClassHandler::MethodCache *cls_method_cache)
 {
   const MOSDOp *m = static_cast<const MOSDOp*>(op->get_req());
   vector<OSDOp>::const_iterator iter;
@@ -9226,8 +9491,13 @@ int OSD::init_op_flags(OpRequestRef& op)
 	bp.copy(iter->op.cls.class_len, cname);
 	bp.copy(iter->op.cls.method_len, mname);
 
-	ClassHandler::ClassData *cls;
-	int r = class_handler->open_class(cname, &cls);
+	ClassHandler::ClassMethod *method;
+	int flags;
+	int r = cls_method_cache->get(cname, mname, &method, &flags);
+	if (r == -EOPNOTSUPP) {
+	  // no such method
+	  return r;
+	}
 	if (r) {
 	  derr << "class " << cname << " open got " << cpp_strerror(r) << dendl;
 	  if (r == -ENOENT)
@@ -9236,14 +9506,6 @@ int OSD::init_op_flags(OpRequestRef& op)
 	    r = -EIO;
 	  return r;
 	}
-	int flags = cls->get_method_flags(mname.c_str());
-	if (flags < 0) {
-	  if (flags == -ENOENT)
-	    r = -EOPNOTSUPP;
-	  else
-	    r = flags;
-	  return r;
-	}
 	is_read = flags & CLS_METHOD_RD;
 	is_write = flags & CLS_METHOD_WR;
         bool is_promote = flags & CLS_METHOD_PROMOTE;
@@ -9260,7 +9522,7 @@ int OSD::init_op_flags(OpRequestRef& op)
         if (is_promote)
           op->set_promote();
         op->add_class(std::move(cname), std::move(mname), is_read, is_write,
-                      cls->whitelisted);
+                      method->cls->whitelisted);
 	break;
       }
 
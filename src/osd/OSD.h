@@ -27,6 +27,7 @@
 #include "common/ceph_context.h"
 #include "common/config_cacher.h"
 #include "common/zipkin_trace.h"
+#include "include/spinlock.h"
 
 #include "mgr/MgrClient.h"
 
@@ -42,6 +43,7 @@
 #include "Session.h"
 
 #include "osd/OpQueueItem.h"
+#include "osd/RecoveryController.h"
 
 #include <atomic>
 #include <map>
@@ -186,6 +188,10 @@ enum {
   l_osd_pg_fastinfo,
   l_osd_pg_biginfo,
 
+  l_osd_recovery_ctl_max_active,
+  l_osd_recovery_ctl_sleep,
+  l_osd_recovery_ctl_client_lat,
+
   l_osd_last,
 };
 
@@ -275,6 +281,13 @@ public:
   PerfCounters *&recoverystate_perf;
   MonClient   *&monc;
   ClassHandler  *&class_handler;
+  GenContextWQ &async_read_wq;
+  const unsigned async_read_threads;
+
+  /// true if client reads on replicated pools go to async_read_wq
+  bool async_reads_enabled() const {
+    return async_read_threads > 0;
+  }
 
   md_config_cacher_t<uint64_t> osd_max_object_size;
   md_config_cacher_t<bool> osd_skip_data_digest;
@@ -741,8 +754,14 @@ public:
   Mutex scrub_sleep_lock;
   SafeTimer scrub_sleep_timer;
 
+  // -- delayed work on behalf of client ops (ec read hedging) --
+  Mutex op_work_lock;
+  SafeTimer op_work_timer;
+
   AsyncReserver<spg_t> snap_reserver;
   void queue_recovery_context(PG *pg, GenContext<ThreadPool::TPHandle&> *c);
+  void queue_op_context(spg_t pgid, OpRequestRef op,
+			GenContext<ThreadPool::TPHandle&> *c);
   void queue_for_snap_trim(PG *pg);
   void queue_for_scrub(PG *pg, bool with_high_priority);
   void queue_for_pg_delete(spg_t pgid, epoch_t e);
@@ -761,10 +780,14 @@ private:
   map<spg_t, set<hobject_t> > recovery_oids;
 #endif
   bool _recover_now(uint64_t *available_pushes);
+  uint64_t _get_recovery_max_active();
   void _maybe_queue_recovery();
   void _queue_for_recovery(
     pair<epoch_t, PGRef> p, uint64_t reserved_pushes);
 public:
+  /// latency driven recovery throttle; see osd_recovery_controller_*
+  RecoveryController recovery_controller;
+
   void start_recovery_op(PG *pg, const hobject_t& soid);
   void finish_recovery_op(PG *pg, const hobject_t& soid, bool dequeue);
   bool is_recovery_active();
@@ -822,6 +845,17 @@ public:
   /// final pg_num values for recently deleted pools
   map<int64_t,int> deleted_pool_pg_nums;
 
+  /// pg mappings an incremental map may have changed
+  struct map_mapping_delta_t {
+    set<int64_t> pools;  ///< pools whose pgs may all have remapped
+    set<pg_t> pgs;       ///< pgs with pg_temp, primary_temp or upmap changes
+    bool affects(pg_t pgid) const {
+      return pools.count(pgid.pool()) || pgs.count(pgid);
+    }
+  };
+  /// epochs whose incremental cannot remap pgs beyond its delta
+  map<epoch_t, map_mapping_delta_t> map_mapping_deltas;
+
   OSDMapRef try_get_map(epoch_t e);
   OSDMapRef get_map(epoch_t e) {
     OSDMapRef ret(try_get_map(e));
@@ -852,6 +886,12 @@ public:
   void _add_map_inc_bl(epoch_t e, bufferlist& bl);
   bool get_inc_map_bl(epoch_t e, bufferlist& bl);
 
+  /// remember which pg mappings inc can change; nothing if it may remap all
+  void note_map_mapping_delta(const OSDMap::Incremental& inc);
+  /// true if pgid maps as it did in e - 1 for every epoch in (from, to]
+  bool pg_mapping_unchanged(pg_t pgid, epoch_t from, epoch_t to);
+  void trim_map_mapping_deltas(epoch_t oldest);
+
   /// get last pg_num before a pool was deleted (if any)
   int get_deleted_pool_pg_num(int64_t pool);
 
@@ -1435,6 +1475,8 @@ private:
 
   ShardedThreadPool osd_op_tp;
   ThreadPool command_tp;
+  ThreadPool async_read_tp;
+  GenContextWQ async_read_wq;
 
   void get_latest_osdmap();
 
@@ -1556,6 +1598,18 @@ private:
   Messenger *hb_back_server_messenger;
   utime_t last_heartbeat_resample;   ///< last time we chose random peers in waiting-for-healthy state
   double daily_loadavg;
+
+  /// osd -> last data reply received from it; stands in for back pings
+  ceph::spinlock peer_data_rx_lock;
+  map<int, utime_t> peer_data_rx;
+  md_config_cacher_t<bool> osd_heartbeat_use_data_traffic;
+  double hb_rtt_avg;  ///< smoothed ping round trip time (sec)
+  double hb_rtt_dev;  ///< smoothed ping round trip deviation (sec)
+
+  void note_peer_data_rx(int peer);
+  void _apply_peer_data_rx();
+  void _note_heartbeat_rtt(utime_t rtt);
+  double _get_heartbeat_interval();
   
   void _add_heartbeat_peer(int p);
   void _remove_heartbeat_peer(int p);
@@ -2216,12 +2270,15 @@ private:
   void handle_fast_scrub(struct MOSDScrub2 *m);
   void handle_osd_ping(class MOSDPing *m);
 
-  int init_op_flags(OpRequestRef& op);
+  int init_op_flags(OpRequestRef& op,
+		    ClassHandler::MethodCache *cls_method_cache);
 
   int get_num_op_shards();
   int get_num_op_threads();
 
   float get_osd_recovery_sleep();
+  float get_osd_recovery_sleep_conf();
+  void update_recovery_controller();
 
   void probe_smart(ostream& ss);
   int probe_smart_device(const char *device, int timeout, std::string *result);
@@ -74,6 +74,16 @@ void PGRecoveryContext::run(
   pg->unlock();
 }
 
+void PGOpContext::run(
+  OSD *osd,
+  OSDShard *sdata,
+  PGRef& pg,
+  ThreadPool::TPHandle &handle)
+{
+  c.release()->complete(handle);
+  pg->unlock();
+}
+
 void PGDelete::run(
   OSD *osd,
   OSDShard *sdata,
@@ -58,6 +58,11 @@ public:
     virtual boost::optional<OpRequestRef> maybe_get_op() const {
       return boost::none;
     }
+    /// true only for the queue entry of the client op itself, not for
+    /// work later queued on its behalf; mclock charges the client once
+    virtual bool is_client_request() const {
+      return false;
+    }
 
     virtual uint64_t get_reserved_pushes() const {
       return 0;
@@ -127,6 +132,9 @@ public:
   boost::optional<OpRequestRef> maybe_get_op() const {
     return qitem->maybe_get_op();
   }
+  bool is_client_request() const {
+    return qitem->is_client_request();
+  }
   uint64_t get_reserved_pushes() const {
     return qitem->get_reserved_pushes();
   }
@@ -211,6 +219,9 @@ public:
   boost::optional<OpRequestRef> maybe_get_op() const override final {
     return op;
   }
+  bool is_client_request() const override final {
+    return true;
+  }
   void run(OSD *osd, OSDShard *sdata, PGRef& pg, ThreadPool::TPHandle &handle) override final;
 };
 
@@ -321,6 +332,31 @@ public:
     OSD *osd, OSDShard *sdata, PGRef& pg, ThreadPool::TPHandle &handle) override final;
 };
 
+/// work done for a client op off the op shard, completing on it
+class PGOpContext : public PGOpQueueable {
+  OpRequestRef op;
+  unique_ptr<GenContext<ThreadPool::TPHandle&>> c;
+  epoch_t epoch;
+public:
+  PGOpContext(spg_t pgid, OpRequestRef op,
+	      GenContext<ThreadPool::TPHandle&> *c, epoch_t epoch)
+    : PGOpQueueable(pgid), op(op), c(c), epoch(epoch) {}
+  op_type_t get_op_type() const override final {
+    return op_type_t::client_op;
+  }
+  ostream &print(ostream &rhs) const override final {
+    return rhs << "PGOpContext(pgid=" << get_pgid()
+	       << " op=" << *(op->get_req())
+	       << " c=" << c.get() << " epoch=" << epoch
+	       << ")";
+  }
+  boost::optional<OpRequestRef> maybe_get_op() const override final {
+    return op;
+  }
+  void run(
+    OSD *osd, OSDShard *sdata, PGRef& pg, ThreadPool::TPHandle &handle) override final;
+};
+
 class PGDelete : public PGOpQueueable {
   epoch_t epoch_queued;
 public:
@@ -121,7 +121,7 @@ public:
     }
   }
 
-  const char *state_string() const override {
+  string state_string() const override {
     switch(latest_flag_point) {
     case flag_queued_for_pg: return "queued for pg";
     case flag_reached_pg: return "reached pg";
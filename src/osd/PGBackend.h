@@ -145,6 +145,32 @@ typedef ceph::shared_ptr<const OSDMap> OSDMapRef;
      virtual GenContext<ThreadPool::TPHandle&> *bless_unlocked_gencontext(
        GenContext<ThreadPool::TPHandle&> *c) = 0;
 
+     /**
+      * Queue work that reads from the store without the pg lock
+      *
+      * Runs c on the osd's async read threads; only used when
+      * OSDService::async_reads_enabled().
+      */
+     virtual void queue_async_read(
+       GenContext<ThreadPool::TPHandle&> *c) = 0;
+
+     /**
+      * Queue c to run under the pg lock on the pg's op shard
+      *
+      * Hands work done off the op shard back to the pg.  op is the
+      * client op it was done for; the completion is queued at its
+      * priority and in its queue class.  Safe to call without the pg
+      * lock.
+      */
+     virtual void queue_op_context(
+       OpRequestRef op,
+       GenContext<ThreadPool::TPHandle&> *c) = 0;
+     /// queue_op_context, but only once delay seconds have passed
+     virtual void schedule_op_work_after(
+       OpRequestRef op,
+       GenContext<ThreadPool::TPHandle&> *c,
+       float delay) = 0;
+
      virtual void send_message(int to_osd, Message *m) = 0;
      virtual void queue_transaction(
        ObjectStore::Transaction&& t,
@@ -556,7 +582,8 @@ typedef ceph::shared_ptr<const OSDMap> OSDMapRef;
      const hobject_t &hoid,
      const list<pair<boost::tuple<uint64_t, uint64_t, uint32_t>,
 		pair<bufferlist*, Context*> > > &to_read,
-     Context *on_complete, bool fast_read = false) = 0;
+     Context *on_complete, bool fast_read = false,
+     OpRequestRef op = OpRequestRef()) = 0;
 
    virtual bool auto_repair_supported() const = 0;
    int be_scan_list(
@@ -788,20 +788,40 @@ void PGLog::_write_log_and_missing(
   set<string> *log_keys_debug
   ) {
   set<string> to_remove;
-  to_remove.swap(trimmed_dups);
-  for (auto& t : trimmed) {
-    string key = t.get_key_name();
+
+  if (touch_log)
+    t.touch(coll, log_oid);
+
+  // Trimming only ever drops the oldest log entries and dups, so the
+  // trimmed keys form one contiguous run at the start of their key
+  // space.  Remove each run with a single range delete instead of a
+  // tombstone per key.
+  if (!trimmed.empty()) {
+    if (log_keys_debug) {
+      for (auto& v : trimmed) {
+	auto it = log_keys_debug->find(v.get_key_name());
+	assert(it != log_keys_debug->end());
+	log_keys_debug->erase(it);
+      }
+    }
+    eversion_t end = *trimmed.rbegin();
+    ++end.version;
+    string first = trimmed.begin()->get_key_name();
+    string last = end.get_key_name();
     if (log_keys_debug) {
-      auto it = log_keys_debug->find(key);
-      assert(it != log_keys_debug->end());
-      log_keys_debug->erase(it);
+      auto it = log_keys_debug->lower_bound(first);
+      assert(it == log_keys_debug->end() || *it >= last);
     }
-    to_remove.emplace(std::move(key));
+    t.omap_rmkeyrange(coll, log_oid, first, last);
+    trimmed.clear();
+  }
+  if (!trimmed_dups.empty()) {
+    string last = *trimmed_dups.rbegin();
+    last.push_back('\0');
+    t.omap_rmkeyrange(coll, log_oid, *trimmed_dups.begin(), last);
+    trimmed_dups.clear();
   }
-  trimmed.clear();
 
-  if (touch_log)
-    t.touch(coll, log_oid);
   if (dirty_to != eversion_t()) {
     t.omap_rmkeyrange(
       coll, log_oid,
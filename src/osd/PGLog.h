@@ -74,15 +74,36 @@ struct PGLog : DoutPrefixProvider {
   };
 
 public:
+  /**
+   * The object index is keyed by a reference to the soid of the log
+   * entry it maps to, so that it does not hold a second copy of every
+   * object name in the log.  Keys must be updated together with the
+   * entry they point at; see IndexedLog::index_object().
+   */
+  typedef std::reference_wrapper<const hobject_t> hobject_ref_t;
+  struct hobject_ref_hash {
+    size_t operator()(const hobject_ref_t &r) const {
+      return std::hash<hobject_t>()(r.get());
+    }
+  };
+  struct hobject_ref_equal {
+    bool operator()(const hobject_ref_t &l, const hobject_ref_t &r) const {
+      return l.get() == r.get();
+    }
+  };
+  typedef mempool::osd_pglog::unordered_map<
+    hobject_ref_t, pg_log_entry_t*,
+    hobject_ref_hash, hobject_ref_equal> object_index_t;
+
   /**
    * IndexLog - adds in-memory index of the log, by oid.
    * plus some methods to manipulate it all.
    */
   struct IndexedLog : public pg_log_t {
-    mutable ceph::unordered_map<hobject_t,pg_log_entry_t*> objects;  // ptrs into log.  be careful!
-    mutable ceph::unordered_map<osd_reqid_t,pg_log_entry_t*> caller_ops;
-    mutable ceph::unordered_multimap<osd_reqid_t,pg_log_entry_t*> extra_caller_ops;
-    mutable ceph::unordered_map<osd_reqid_t,pg_log_dup_t*> dup_index;
+    mutable object_index_t objects;  // ptrs into log.  be careful!
+    mutable mempool::osd_pglog::unordered_map<osd_reqid_t,pg_log_entry_t*> caller_ops;
+    mutable mempool::osd_pglog::unordered_multimap<osd_reqid_t,pg_log_entry_t*> extra_caller_ops;
+    mutable mempool::osd_pglog::unordered_map<osd_reqid_t,pg_log_dup_t*> dup_index;
 
     // recovery pointers
     list<pg_log_entry_t>::iterator complete_to; // not inclusive of referenced item
@@ -270,7 +291,7 @@ public:
       assert(version);
       assert(user_version);
       assert(return_code);
-      ceph::unordered_map<osd_reqid_t,pg_log_entry_t*>::const_iterator p;
+      decltype(caller_ops)::const_iterator p;
       if (!(indexed_data & PGLOG_INDEXED_CALLER_OPS)) {
         index_caller_ops();
       }
@@ -373,7 +394,7 @@ public:
 	     ++i) {
 	  if (to_index & PGLOG_INDEXED_OBJECTS) {
 	    if (i->object_is_indexed()) {
-	      objects[i->soid] = const_cast<pg_log_entry_t*>(&(*i));
+	      index_object(const_cast<pg_log_entry_t*>(&(*i)));
 	    }
 	  }
 
@@ -401,6 +422,19 @@ public:
       index(PGLOG_INDEXED_OBJECTS);
     }
 
+    /// point the object index at e, rekeying any existing entry
+    void index_object(pg_log_entry_t *e) const {
+      auto p = objects.find(e->soid);
+      if (p == objects.end()) {
+	objects.emplace(std::cref(e->soid), e);
+      } else {
+	auto node = objects.extract(p);
+	node.key() = std::cref(e->soid);
+	node.mapped() = e;
+	objects.insert(std::move(node));
+      }
+    }
+
     void index_caller_ops() const {
       index(PGLOG_INDEXED_CALLER_OPS);
     }
@@ -415,9 +449,9 @@ public:
 
     void index(pg_log_entry_t& e) {
       if ((indexed_data & PGLOG_INDEXED_OBJECTS) && e.object_is_indexed()) {
-        if (objects.count(e.soid) == 0 ||
-            objects[e.soid]->version < e.version)
-          objects[e.soid] = &e;
+	auto p = objects.find(e.soid);
+	if (p == objects.end() || p->second->version < e.version)
+	  index_object(&e);
       }
       if (indexed_data & PGLOG_INDEXED_CALLER_OPS) {
 	// divergent merge_log indexes new before unindexing old
@@ -461,8 +495,7 @@ public:
         for (auto j = e.extra_reqids.begin();
              j != e.extra_reqids.end();
              ++j) {
-          for (ceph::unordered_multimap<osd_reqid_t,pg_log_entry_t*>::iterator k =
-		 extra_caller_ops.find(j->first);
+          for (auto k = extra_caller_ops.find(j->first);
                k != extra_caller_ops.end() && k->first == j->first;
                ++k) {
             if (k->second == &e) {
@@ -511,7 +544,7 @@ public:
 
       // to our index
       if ((indexed_data & PGLOG_INDEXED_OBJECTS) && e.object_is_indexed()) {
-        objects[e.soid] = &(log.back());
+	index_object(&(log.back()));
       }
       if (indexed_data & PGLOG_INDEXED_CALLER_OPS) {
         if (e.reqid_is_indexed()) {
@@ -910,8 +943,7 @@ protected:
 		       << " last_divergent_update: " << last_divergent_update
 		       << dendl;
 
-    ceph::unordered_map<hobject_t, pg_log_entry_t*>::const_iterator objiter =
-      log.objects.find(hoid);
+    object_index_t::const_iterator objiter = log.objects.find(hoid);
     if (objiter != log.objects.end() &&
 	objiter->second->version >= first_divergent_update) {
       /// Case 1)
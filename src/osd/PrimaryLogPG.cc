@@ -270,7 +270,7 @@ void PrimaryLogPG::OpContext::start_async_reads(PrimaryLogPG *pg)
   pg->pgbackend->objects_read_async(
     obc->obs.oi.soid,
     in,
-    new OnReadComplete(pg, this), pg->get_pool().fast_read);
+    new OnReadComplete(pg, this), pg->get_pool().fast_read, op);
 }
 void PrimaryLogPG::OpContext::finish_read(PrimaryLogPG *pg)
 {
@@ -514,6 +514,35 @@ void PrimaryLogPG::schedule_recovery_work(
   osd->queue_recovery_context(this, c);
 }
 
+class C_QueueOpWork : public Context {
+  OSDService *osd;
+  spg_t pgid;
+  OpRequestRef op;
+  GenContext<ThreadPool::TPHandle&> *c;
+public:
+  C_QueueOpWork(OSDService *osd, spg_t pgid, OpRequestRef op,
+		GenContext<ThreadPool::TPHandle&> *c)
+    : osd(osd), pgid(pgid), op(op), c(c) {}
+  ~C_QueueOpWork() override {
+    delete c;
+  }
+  void finish(int r) override {
+    osd->queue_op_context(pgid, op, c);
+    c = nullptr;
+  }
+};
+
+void PrimaryLogPG::schedule_op_work_after(
+  OpRequestRef op,
+  GenContext<ThreadPool::TPHandle&> *c,
+  float delay)
+{
+  Mutex::Locker l(osd->op_work_lock);
+  osd->op_work_timer.add_event_after(
+    delay,
+    new C_QueueOpWork(osd, pg_id, op, c));
+}
+
 void PrimaryLogPG::send_message_osd_cluster(
   int peer, Message *m, epoch_t from_epoch)
 {
@@ -1660,6 +1689,7 @@ PrimaryLogPG::PrimaryLogPG(OSDService *o, OSDMapRef curmap,
     PGBackend::build_pg_backend(
       _pool.info, ec_profile, this, coll_t(p), ch, o->store, cct)),
   object_contexts(o->cct, o->cct->_conf->osd_pg_object_context_cache_count),
+  cls_method_cache(o->class_handler),
   snapset_contexts_lock("PrimaryLogPG::snapset_contexts_lock"),
   new_backfill(false),
   temp_seq(0),
@@ -1945,7 +1975,7 @@ void PrimaryLogPG::do_op(OpRequestRef& op)
   }
 
   if (op->rmw_flags == 0) {
-    int r = osd->osd->init_op_flags(op);
+    int r = osd->osd->init_op_flags(op, &cls_method_cache);
     if (r) {
       osd->reply_op_error(op, r);
       return;
@@ -3430,6 +3460,26 @@ struct SetManifestFinisher : public PrimaryLogPG::OpFinisher {
   }
 };
 
+// replicated pools repair a primary read error the way the sync path does
+struct RepReadFinisher : public PrimaryLogPG::OpFinisher {
+  PrimaryLogPG *primary_log_pg;
+  OSDOp& osd_op;
+  hobject_t soid;
+  OpRequestRef op;
+
+  RepReadFinisher(PrimaryLogPG *primary_log_pg, OSDOp& osd_op,
+		  const hobject_t& soid, OpRequestRef op)
+    : primary_log_pg(primary_log_pg), osd_op(osd_op), soid(soid), op(op) {
+  }
+
+  int execute() override {
+    if (osd_op.rval == -EIO) {
+      return primary_log_pg->rep_repair_primary_object(soid, op);
+    }
+    return osd_op.rval;
+  }
+};
+
 void PrimaryLogPG::refcount_manifest(ObjectContextRef obc, object_locator_t oloc, hobject_t soid,
                                      SnapContext snapc, bool get, Context *cb, uint64_t offset)
 {
@@ -3876,7 +3926,6 @@ void PrimaryLogPG::execute_ctx(OpContext *ctx)
   if (result == -EINPROGRESS || pending_async_reads) {
     // come back later.
     if (pending_async_reads) {
-      assert(pool.info.is_erasure());
       in_progress_async_reads.push_back(make_pair(op, ctx));
       ctx->start_async_reads(this);
     }
@@ -4059,6 +4108,7 @@ void PrimaryLogPG::log_op_stats(OpContext *ctx)
   osd->logger->inc(l_osd_op_inb, inb);
   osd->logger->tinc(l_osd_op_lat, latency);
   osd->logger->tinc(l_osd_op_process_lat, process_latency);
+  osd->recovery_controller.add_client_op_latency(latency);
 
   if (op->may_read() && op->may_write()) {
     osd->logger->inc(l_osd_op_rw);
@@ -4986,6 +5036,46 @@ struct ToSparseReadResult : public Context {
   }
 };
 
+// a replicated sparse read whose extents were read asynchronously
+struct RepSparseReadFinisher : public PrimaryLogPG::OpFinisher {
+  PrimaryLogPG *primary_log_pg;
+  PrimaryLogPG::OpContext *ctx;
+  OSDOp& osd_op;
+  map<uint64_t, uint64_t> extents;      ///< from fiemap
+  vector<pair<int, bufferlist>> reads;  ///< result and data, per extent
+
+  RepSparseReadFinisher(PrimaryLogPG *primary_log_pg,
+			PrimaryLogPG::OpContext *ctx, OSDOp& osd_op,
+			const map<uint64_t, uint64_t>& extents)
+    : primary_log_pg(primary_log_pg), ctx(ctx), osd_op(osd_op),
+      extents(extents), reads(extents.size()) {
+  }
+
+  int execute() override {
+    map<uint64_t, uint64_t> m;
+    bufferlist data_bl;
+    uint64_t total_read = 0;
+    auto read = reads.begin();
+    for (auto& e : extents) {
+      int r = read->first;
+      if (r == -EIO) {
+	return primary_log_pg->rep_repair_primary_object(
+	  ctx->new_obs.oi.soid, ctx->op);
+      }
+      if (r < 0) {
+	return r;
+      }
+      // an extent may run past the end of the object
+      m[e.first] = std::min<uint64_t>(e.second, r);
+      total_read += r;
+      data_bl.claim_append(read->second);
+      ++read;
+    }
+    return primary_log_pg->finish_sparse_read(ctx, osd_op, m, data_bl,
+					      total_read);
+  }
+};
+
 template<typename V>
 static string list_keys(const map<string, V>& m) {
   string s;
@@ -5399,7 +5489,7 @@ int PrimaryLogPG::do_read(OpContext *ctx, OSDOp& osd_op) {
     // read size was trimmed to zero and it is expected to do nothing
     // a read operation of 0 bytes does *not* do nothing, this is why
     // the trimmed_read boolean is needed
-  } else if (pool.info.is_erasure()) {
+  } else if (pool.info.is_erasure() || can_read_async(ctx, osd_op)) {
     // The initialisation below is required to silence a false positive
     // -Wmaybe-uninitialized warning
     boost::optional<uint32_t> maybe_crc = boost::make_optional(false, uint32_t());
@@ -5418,8 +5508,13 @@ int PrimaryLogPG::do_read(OpContext *ctx, OSDOp& osd_op) {
 					 osd, soid, op.flags))));
     dout(10) << " async_read noted for " << soid << dendl;
 
-    ctx->op_finishers[ctx->current_osd_subop_num].reset(
-      new ReadFinisher(osd_op));
+    if (pool.info.is_erasure()) {
+      ctx->op_finishers[ctx->current_osd_subop_num].reset(
+	new ReadFinisher(osd_op));
+    } else {
+      ctx->op_finishers[ctx->current_osd_subop_num].reset(
+	new RepReadFinisher(this, osd_op, soid, ctx->op));
+    }
   } else {
     int r = pgbackend->objects_read_sync(
       soid, op.extent.offset, op.extent.length, op.flags, &osd_op.outdata);
@@ -5454,6 +5549,19 @@ int PrimaryLogPG::do_read(OpContext *ctx, OSDOp& osd_op) {
   return result;
 }
 
+bool PrimaryLogPG::can_read_async(OpContext *ctx, const OSDOp& osd_op) const
+{
+  if (pool.info.is_erasure() || !osd->async_reads_enabled())
+    return false;
+  // only plain client reads: writes and cache ops need the data to
+  // build the transaction, and nested do_osd_ops() callers (cls
+  // methods, cmpext, checksum) use what they read right away.
+  if (!ctx->op || ctx->op->may_write() || ctx->op->may_cache())
+    return false;
+  return ctx->ops && !ctx->ops->empty() &&
+    &osd_op >= &ctx->ops->front() && &osd_op <= &ctx->ops->back();
+}
+
 int PrimaryLogPG::do_sparse_read(OpContext *ctx, OSDOp& osd_op) {
   dout(20) << __func__ << dendl;
   auto& op = osd_op.op;
@@ -5504,6 +5612,33 @@ int PrimaryLogPG::do_sparse_read(OpContext *ctx, OSDOp& osd_op) {
       return r;
     }
 
+    // the extent map comes from the store's metadata, so only the data
+    // needs to be read on the async read threads.  Verifying holes reads
+    // them as well, and stays synchronous.
+    if (!m.empty() && !cct->_conf->osd_verify_sparse_read_holes &&
+	can_read_async(ctx, osd_op)) {
+      auto finisher = new RepSparseReadFinisher(this, ctx, osd_op, m);
+      uint64_t total = 0;
+      auto read = finisher->reads.begin();
+      for (auto& e : m) {
+	auto& result = read->first;
+	ctx->pending_async_reads.push_back(
+	  make_pair(
+	    boost::make_tuple(e.first, e.second, op.flags),
+	    make_pair(&read->second,
+		      new FunctionContext([&result](int r) { result = r; }))));
+	total += e.second;
+	++read;
+      }
+      ctx->op_finishers[ctx->current_osd_subop_num].reset(finisher);
+      dout(10) << " async sparse_read of " << m.size() << " extents noted for "
+	       << soid << dendl;
+      // as for async reads, count the requested length
+      ctx->delta_stats.num_rd_kb += shift_round_up(total, 10);
+      ctx->delta_stats.num_rd++;
+      return 0;
+    }
+
     map<uint64_t, uint64_t>::iterator miter;
     bufferlist data_bl;
     uint64_t last = op.extent.offset;
@@ -5565,33 +5700,47 @@ int PrimaryLogPG::do_sparse_read(OpContext *ctx, OSDOp& osd_op) {
       }
     }
 
-    // Why SPARSE_READ need checksum? In fact, librbd always use sparse-read.
-    // Maybe at first, there is no much whole objects. With continued use, more
-    // and more whole object exist. So from this point, for spare-read add
-    // checksum make sense.
-    if (total_read == oi.size && oi.is_data_digest()) {
-      uint32_t crc = data_bl.crc32c(-1);
-      if (oi.data_digest != crc) {
-        osd->clog->error() << info.pgid << std::hex
-          << " full-object read crc 0x" << crc
-          << " != expected 0x" << oi.data_digest
-          << std::dec << " on " << soid;
-        // FIXME fall back to replica or something?
-        return -EIO;
-      }
+    r = finish_sparse_read(ctx, osd_op, m, data_bl, total_read);
+    if (r < 0) {
+      return r;
     }
+  }
 
-    op.extent.length = total_read;
+  ctx->delta_stats.num_rd_kb += shift_round_up(op.extent.length, 10);
+  ctx->delta_stats.num_rd++;
+  return 0;
+}
 
-    encode(m, osd_op.outdata); // re-encode since it might be modified
-    ::encode_destructively(data_bl, osd_op.outdata);
+int PrimaryLogPG::finish_sparse_read(OpContext *ctx, OSDOp& osd_op,
+				     const map<uint64_t, uint64_t>& m,
+				     bufferlist& data_bl, uint64_t total_read)
+{
+  auto& oi = ctx->new_obs.oi;
+  auto& soid = oi.soid;
 
-    dout(10) << " sparse_read got " << total_read << " bytes from object "
-	     << soid << dendl;
+  // Why SPARSE_READ need checksum? In fact, librbd always use sparse-read.
+  // Maybe at first, there is no much whole objects. With continued use, more
+  // and more whole object exist. So from this point, for spare-read add
+  // checksum make sense.
+  if (total_read == oi.size && oi.is_data_digest()) {
+    uint32_t crc = data_bl.crc32c(-1);
+    if (oi.data_digest != crc) {
+      osd->clog->error() << info.pgid << std::hex
+        << " full-object read crc 0x" << crc
+        << " != expected 0x" << oi.data_digest
+        << std::dec << " on " << soid;
+      // FIXME fall back to replica or something?
+      return -EIO;
+    }
   }
 
-  ctx->delta_stats.num_rd_kb += shift_round_up(op.extent.length, 10);
-  ctx->delta_stats.num_rd++;
+  osd_op.op.extent.length = total_read;
+
+  encode(m, osd_op.outdata); // re-encode since it might be modified
+  ::encode_destructively(data_bl, osd_op.outdata);
+
+  dout(10) << " sparse_read got " << total_read << " bytes from object "
+	   << soid << dendl;
   return 0;
 }
 
@@ -5787,18 +5936,15 @@ int PrimaryLogPG::do_osd_ops(OpContext *ctx, vector<OSDOp>& ops)
 	}
 	tracepoint(osd, do_osd_op_pre_call, soid.oid.name.c_str(), soid.snap.val, cname.c_str(), mname.c_str());
 
-	ClassHandler::ClassData *cls;
-	result = osd->class_handler->open_class(cname, &cls);
-	assert(result == 0);   // init_op_flags() already verified this works.
-
-	ClassHandler::ClassMethod *method = cls->get_method(mname.c_str());
-	if (!method) {
+	ClassHandler::ClassMethod *method;
+	int flags;
+	result = cls_method_cache.get(cname, mname, &method, &flags);
+	if (result == -EOPNOTSUPP) {
 	  dout(10) << "call method " << cname << "." << mname << " does not exist" << dendl;
-	  result = -EOPNOTSUPP;
 	  break;
 	}
+	assert(result == 0);   // init_op_flags() already verified this works.
 
-	int flags = method->get_flags();
 	if (flags & CLS_METHOD_WR)
 	  ctx->user_modify = true;
 
@@ -8160,17 +8306,24 @@ void PrimaryLogPG::do_osd_op_effects(OpContext *ctx, const ConnectionRef& conn)
   for (list<OpContext::NotifyAck>::iterator p = ctx->notify_acks.begin();
        p != ctx->notify_acks.end();
        ++p) {
-    if (p->watch_cookie)
+    if (p->watch_cookie) {
+      // the watch is keyed by (cookie, entity); look it up directly
+      // rather than scanning every watcher of a (possibly hot) object
       dout(10) << "notify_ack " << make_pair(p->watch_cookie.get(), p->notify_id) << dendl;
-    else
-      dout(10) << "notify_ack " << make_pair("NULL", p->notify_id) << dendl;
+      auto i = ctx->obc->watchers.find(
+	make_pair(p->watch_cookie.get(), entity));
+      if (i != ctx->obc->watchers.end()) {
+	dout(10) << "acking notify on watch " << i->first << dendl;
+	i->second->notify_ack(p->notify_id, p->reply_bl);
+      }
+      continue;
+    }
+    dout(10) << "notify_ack " << make_pair("NULL", p->notify_id) << dendl;
     for (map<pair<uint64_t, entity_name_t>, WatchRef>::iterator i =
 	   ctx->obc->watchers.begin();
 	 i != ctx->obc->watchers.end();
 	 ++i) {
       if (i->first.second != entity) continue;
-      if (p->watch_cookie &&
-	  p->watch_cookie.get() != i->first.first) continue;
       dout(10) << "acking notify on watch " << i->first << dendl;
       i->second->notify_ack(p->notify_id, p->reply_bl);
     }
@@ -8257,6 +8410,11 @@ int PrimaryLogPG::prepare_transaction(OpContext *ctx)
   }
 
   const hobject_t& soid = ctx->obs->oi.soid;
+  // make_writeable() trims modified_ranges to the clone overlap, so
+  // take the extents for the log entry first
+  interval_set<uint64_t> modified_extents;
+  bool extents_tracked = calc_modified_extents(ctx, &modified_extents);
+
   // clone, if necessary
   if (soid.snap == CEPH_NOSNAP)
     make_writeable(ctx);
@@ -8264,10 +8422,88 @@ int PrimaryLogPG::prepare_transaction(OpContext *ctx)
   finish_ctx(ctx,
 	     ctx->new_obs.exists ? pg_log_entry_t::MODIFY :
 	     pg_log_entry_t::DELETE);
+  if (extents_tracked && ctx->log.back().is_modify()) {
+    ctx->log.back().set_modified_extents(modified_extents);
+  }
 
   return result;
 }
 
+/*
+ * Work out which data extents of the head this op changed, so that
+ * recovery of a replica that only missed updates like this one can
+ * push just those extents.  This only holds for ops that modify an
+ * existing object in place: anything that may replace the object or
+ * change its data outside of modified_ranges (delete, rollback,
+ * copy-from, class methods, tiering, ...) is left untracked.
+ */
+bool PrimaryLogPG::calc_modified_extents(OpContext *ctx,
+					 interval_set<uint64_t> *extents)
+{
+  if (!cct->_conf->get_val<bool>("osd_recover_modified_extents") ||
+      pool.info.is_erasure())
+    return false;
+  const hobject_t& soid = ctx->obs->oi.soid;
+  if (soid.snap != CEPH_NOSNAP ||
+      !ctx->obs->exists || ctx->obs->oi.is_whiteout() ||
+      !ctx->new_obs.exists || ctx->new_obs.oi.is_whiteout())
+    return false;
+
+  for (auto& osd_op : *ctx->ops) {
+    // a class method may do anything to the object but is an RD op
+    if (osd_op.op.op == CEPH_OSD_OP_CALL) {
+      dout(20) << __func__ << " " << soid << " not tracking extents for "
+	       << ceph_osd_op_name(osd_op.op.op) << dendl;
+      return false;
+    }
+    if (!ceph_osd_op_mode_modify(osd_op.op.op))
+      continue;
+    switch (osd_op.op.op) {
+    case CEPH_OSD_OP_WRITE:
+    case CEPH_OSD_OP_WRITEFULL:
+    case CEPH_OSD_OP_WRITESAME:
+    case CEPH_OSD_OP_APPEND:
+    case CEPH_OSD_OP_ZERO:
+    case CEPH_OSD_OP_TRUNCATE:
+    case CEPH_OSD_OP_TRIMTRUNC:
+    case CEPH_OSD_OP_CREATE:
+    case CEPH_OSD_OP_SETALLOCHINT:
+    case CEPH_OSD_OP_SETXATTR:
+    case CEPH_OSD_OP_RMXATTR:
+    case CEPH_OSD_OP_OMAPSETVALS:
+    case CEPH_OSD_OP_OMAPSETHEADER:
+    case CEPH_OSD_OP_OMAPCLEAR:
+    case CEPH_OSD_OP_OMAPRMKEYS:
+    case CEPH_OSD_OP_WATCH:
+      break;
+    default:
+      dout(20) << __func__ << " " << soid << " not tracking extents for "
+	       << ceph_osd_op_name(osd_op.op.op) << dendl;
+      return false;
+    }
+  }
+
+  // modified_ranges is relative to the old object; anything appended
+  // beyond the old size is new data too
+  *extents = ctx->modified_ranges;
+  uint64_t old_size = ctx->obs->oi.size;
+  uint64_t new_size = ctx->new_obs.oi.size;
+  if (new_size > old_size) {
+    interval_set<uint64_t> grown;
+    grown.insert(old_size, new_size - old_size);
+    extents->union_of(grown);
+  }
+  if (extents->num_intervals() >
+      cct->_conf->get_val<uint64_t>(
+	"osd_recover_modified_extents_max_intervals")) {
+    dout(20) << __func__ << " " << soid << " too many extents "
+	     << *extents << dendl;
+    return false;
+  }
+  dout(20) << __func__ << " " << soid << " " << *extents << dendl;
+  return true;
+}
+
 void PrimaryLogPG::finish_ctx(OpContext *ctx, int log_op_type)
 {
   const hobject_t& soid = ctx->obs->oi.soid;
@@ -13392,37 +13628,49 @@ void PrimaryLogPG::hit_set_create()
   HitSet::Params params(pool.info.hit_set_params);
 
   dout(20) << __func__ << " " << params << dendl;
-  if (pool.info.hit_set_params.get_type() == HitSet::TYPE_BLOOM) {
-    BloomHitSet::Params *p =
-      static_cast<BloomHitSet::Params*>(params.impl.get());
-
-    // convert false positive rate so it holds up across the full period
-    p->set_fpp(p->get_fpp() / pool.info.hit_set_count);
-    if (p->get_fpp() <= 0.0)
-      p->set_fpp(.01);  // fpp cannot be zero!
 
-    // if we don't have specified size, estimate target size based on the
-    // previous bin!
-    if (p->target_size == 0 && hit_set) {
+  // if we don't have specified size, estimate target size based on the
+  // previous bin!
+  auto estimate_target_size = [&](uint64_t *target_size) {
+    if (*target_size == 0 && hit_set) {
       utime_t dur = now - hit_set_start_stamp;
       unsigned unique = hit_set->approx_unique_insert_count();
       dout(20) << __func__ << " previous set had approx " << unique
 	       << " unique items over " << dur << " seconds" << dendl;
-      p->target_size = (double)unique * (double)pool.info.hit_set_period
+      *target_size = (double)unique * (double)pool.info.hit_set_period
 		     / (double)dur;
     }
-    if (p->target_size <
+    if (*target_size <
 	static_cast<uint64_t>(cct->_conf->osd_hit_set_min_size))
-      p->target_size = cct->_conf->osd_hit_set_min_size;
+      *target_size = cct->_conf->osd_hit_set_min_size;
 
-    if (p->target_size
+    if (*target_size
 	> static_cast<uint64_t>(cct->_conf->osd_hit_set_max_size))
-      p->target_size = cct->_conf->osd_hit_set_max_size;
+      *target_size = cct->_conf->osd_hit_set_max_size;
+  };
+
+  if (pool.info.hit_set_params.get_type() == HitSet::TYPE_BLOOM) {
+    BloomHitSet::Params *p =
+      static_cast<BloomHitSet::Params*>(params.impl.get());
+
+    // convert false positive rate so it holds up across the full period
+    p->set_fpp(p->get_fpp() / pool.info.hit_set_count);
+    if (p->get_fpp() <= 0.0)
+      p->set_fpp(.01);  // fpp cannot be zero!
 
+    estimate_target_size(&p->target_size);
     p->seed = now.sec();
 
     dout(10) << __func__ << " target_size " << p->target_size
 	     << " fpp " << p->get_fpp() << dendl;
+  } else if (pool.info.hit_set_params.get_type() == HitSet::TYPE_COUNT_MIN) {
+    CountMinHitSet::Params *p =
+      static_cast<CountMinHitSet::Params*>(params.impl.get());
+    estimate_target_size(&p->target_size);
+    p->seed = now.sec();
+
+    dout(10) << __func__ << " target_size " << p->target_size
+	     << " depth " << p->depth << dendl;
   }
   hit_set.reset(new HitSet(params));
   hit_set_start_stamp = now;
@@ -13924,6 +14172,25 @@ bool PrimaryLogPG::agent_maybe_flush(ObjectContextRef& obc)
     return false;
   }
 
+  // with hit counts available, leave the hottest dirty objects for
+  // later while we are only trickling flushes out; they are likely to
+  // be dirtied again before the flush would have done any good
+  if (!evict_mode_full &&
+      agent_state->flush_mode == TierAgentState::FLUSH_MODE_LOW &&
+      hit_set &&
+      pool.info.hit_set_params.get_type() == HitSet::TYPE_COUNT_MIN) {
+    int temp = 0;
+    uint64_t temp_lower = 0, temp_upper = 0;
+    agent_estimate_temp(obc->obs.oi.soid, &temp);
+    agent_state->temp_hist.get_position_micro(temp, &temp_lower, &temp_upper);
+    if (temp_lower >= 900000) {
+      dout(20) << __func__ << " skip (hot, temp " << temp << ") "
+	       << obc->obs.oi << dendl;
+      osd->logger->inc(l_osd_agent_skip);
+      return false;
+    }
+  }
+
   dout(10) << __func__ << " flushing " << obc->obs.oi << dendl;
 
   // FIXME: flush anything dirty, regardless of what distribution of
@@ -14316,20 +14583,35 @@ bool PrimaryLogPG::agent_choose_mode(bool restart, OpRequestRef op)
   return requeued;
 }
 
+/*
+ * each hit set the object appears in adds its grade, weighted by
+ * 1 + log2(hits) for sets that count hits (count_min) so that a
+ * frequently accessed object is hotter than one touched once in the
+ * same period.  presence-only sets always weigh 1.
+ */
+static int hit_weight(unsigned hits)
+{
+  int w = 0;
+  while (hits) {
+    ++w;
+    hits >>= 1;
+  }
+  return w;
+}
+
 void PrimaryLogPG::agent_estimate_temp(const hobject_t& oid, int *temp)
 {
   assert(hit_set);
   assert(temp);
-  *temp = 0;
-  if (hit_set->contains(oid))
-    *temp = 1000000;
+  *temp = 1000000 * hit_weight(hit_set->count(oid));
   unsigned i = 0;
   int last_n = pool.info.hit_set_search_last_n;
   for (map<time_t,HitSetRef>::reverse_iterator p =
        agent_state->hit_set_map.rbegin(); last_n > 0 &&
        p != agent_state->hit_set_map.rend(); ++p, ++i) {
-    if (p->second->contains(oid)) {
-      *temp += pool.info.get_grade(i);
+    int w = hit_weight(p->second->count(oid));
+    if (w) {
+      *temp += pool.info.get_grade(i) * w;
       --last_n;
     }
   }
@@ -308,6 +308,17 @@ public:
     GenContext<ThreadPool::TPHandle&> *c) override;
   GenContext<ThreadPool::TPHandle&> *bless_unlocked_gencontext(
     GenContext<ThreadPool::TPHandle&> *c) override;
+  void queue_async_read(GenContext<ThreadPool::TPHandle&> *c) override {
+    osd->async_read_wq.queue(c);
+  }
+  void queue_op_context(OpRequestRef op,
+			GenContext<ThreadPool::TPHandle&> *c) override {
+    osd->queue_op_context(pg_id, op, c);
+  }
+  void schedule_op_work_after(
+    OpRequestRef op,
+    GenContext<ThreadPool::TPHandle&> *c,
+    float delay) override;
     
   void send_message(int to_osd, Message *m) override {
     osd->send_message_osd_cluster(to_osd, m, get_osdmap()->get_epoch());
@@ -952,6 +963,8 @@ protected:
 
   // projected object info
   SharedLRU<hobject_t, ObjectContext> object_contexts;
+  // resolved cls methods, protected by the pg lock
+  ClassHandler::MethodCache cls_method_cache;
   // map from oid.snapdir() to SnapSetContext *
   map<hobject_t, SnapSetContext*> snapset_contexts;
   Mutex snapset_contexts_lock;
@@ -1122,6 +1135,7 @@ protected:
   void write_update_size_and_usage(object_stat_sum_t& stats, object_info_t& oi,
 				   interval_set<uint64_t>& modified, uint64_t offset,
 				   uint64_t length, bool write_full=false);
+  bool calc_modified_extents(OpContext *ctx, interval_set<uint64_t> *extents);
   inline void truncate_update_size_and_usage(
     object_stat_sum_t& delta_stats,
     object_info_t& oi,
@@ -1359,7 +1373,13 @@ protected:
   friend class C_ExtentCmpRead;
 
   int do_read(OpContext *ctx, OSDOp& osd_op);
+  bool can_read_async(OpContext *ctx, const OSDOp& osd_op) const;
   int do_sparse_read(OpContext *ctx, OSDOp& osd_op);
+  int finish_sparse_read(OpContext *ctx, OSDOp& osd_op,
+			 const map<uint64_t, uint64_t>& m,
+			 bufferlist& data_bl, uint64_t total_read);
+
+  friend struct RepSparseReadFinisher;
   int do_writesame(OpContext *ctx, OSDOp& osd_op);
 
   bool pgls_filter(PGLSFilter *filter, hobject_t& sobj, bufferlist& outdata);
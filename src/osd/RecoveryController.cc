@@ -0,0 +1,156 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "RecoveryController.h"
+#include "common/ceph_context.h"
+#include "common/config.h"
+#include "common/debug.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_osd
+#undef dout_prefix
+#define dout_prefix *_dout << "recovery_controller "
+
+// smallest sleep worth adding, and below which sleep is dropped (sec)
+static const double MIN_SLEEP = 0.001;
+// release the throttle only below this fraction of the target
+static const double RELEASE_RATIO = 0.8;
+
+RecoveryController::RecoveryController(CephContext *cct)
+  : cct(cct),
+    samples(new std::atomic<double>[MAX_SAMPLES]),
+    lock("RecoveryController::lock")
+{
+  for (size_t i = 0; i < MAX_SAMPLES; ++i) {
+    samples[i] = 0;
+  }
+}
+
+void RecoveryController::add_client_op_latency(utime_t lat)
+{
+  if (!enabled)
+    return;
+  uint64_t n = num_samples++;
+  samples[n % MAX_SAMPLES].store((double)lat, std::memory_order_relaxed);
+}
+
+void RecoveryController::update(uint64_t base_max_active, double base_sleep)
+{
+  double new_target = cct->_conf->get_val<double>(
+    "osd_recovery_controller_target_latency");
+  uint64_t ceiling = std::max<uint64_t>(
+    cct->_conf->get_val<uint64_t>("osd_recovery_controller_max_active"), 1);
+  double max_sleep = cct->_conf->get_val<double>(
+    "osd_recovery_controller_max_sleep");
+  uint64_t min_samples = cct->_conf->get_val<uint64_t>(
+    "osd_recovery_controller_min_samples");
+
+  Mutex::Locker l(lock);
+  if (new_target <= 0) {
+    if (enabled) {
+      ldout(cct, 1) << __func__ << " disabled" << dendl;
+    }
+    enabled = false;
+    target = 0;
+    max_active = base_max_active;
+    sleep = base_sleep;
+    client_p99 = 0;
+    return;
+  }
+  if (!enabled) {
+    // start from the static settings
+    ldout(cct, 1) << __func__ << " enabled, target " << new_target << dendl;
+    max_active = std::min(std::max<uint64_t>(base_max_active, 1), ceiling);
+    sleep = std::min(base_sleep, max_sleep);
+    last_samples = num_samples;
+    enabled = true;
+  }
+  target = new_target;
+  ++num_updates;
+
+  uint64_t end = num_samples;
+  uint64_t n = std::min<uint64_t>(end - last_samples, MAX_SAMPLES);
+  last_samples = end;
+  if (n < min_samples || n == 0) {
+    // too little client load to tell; treat as no pressure
+    client_p99 = 0;
+  } else {
+    std::vector<double> window;
+    window.reserve(n);
+    for (uint64_t i = end - n; i < end; ++i) {
+      window.push_back(
+	samples[i % MAX_SAMPLES].load(std::memory_order_relaxed));
+    }
+    auto nth = window.begin() + (n * 99) / 100;
+    std::nth_element(window.begin(), nth, window.end());
+    client_p99 = *nth;
+  }
+
+  uint64_t old_max_active = max_active;
+  double old_sleep = sleep;
+  if (client_p99 > target) {
+    max_active = std::max<uint64_t>(max_active / 2, 1);
+    sleep = std::min(std::max(sleep * 2, MIN_SLEEP), max_sleep);
+    ++num_throttles;
+  } else if (client_p99 < target * RELEASE_RATIO) {
+    if (sleep > 0) {
+      sleep /= 2;
+      if (sleep < MIN_SLEEP)
+	sleep = 0;
+    } else {
+      max_active = std::min(max_active + 1, ceiling);
+    }
+    ++num_releases;
+  }
+  max_active = std::min(max_active, ceiling);
+  sleep = std::min(sleep, max_sleep);
+
+  ldout(cct, 10) << __func__ << " " << n << " samples, p99 " << client_p99
+		 << " target " << target
+		 << ", max_active " << old_max_active << " -> " << max_active
+		 << ", sleep " << old_sleep << " -> " << sleep << dendl;
+}
+
+uint64_t RecoveryController::get_max_active() const
+{
+  Mutex::Locker l(lock);
+  return max_active;
+}
+
+double RecoveryController::get_sleep() const
+{
+  Mutex::Locker l(lock);
+  return sleep;
+}
+
+double RecoveryController::get_client_p99() const
+{
+  Mutex::Locker l(lock);
+  return client_p99;
+}
+
+void RecoveryController::dump(Formatter *f) const
+{
+  Mutex::Locker l(lock);
+  f->dump_bool("enabled", enabled);
+  f->dump_float("target_latency", target);
+  f->dump_float("client_p99_latency", client_p99);
+  f->dump_unsigned("max_active", max_active);
+  f->dump_float("sleep", sleep);
+  f->dump_unsigned("pending_samples", num_samples - last_samples);
+  f->dump_unsigned("updates", num_updates);
+  f->dump_unsigned("throttles", num_throttles);
+  f->dump_unsigned("releases", num_releases);
+}
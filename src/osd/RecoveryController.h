@@ -0,0 +1,86 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef CEPH_OSD_RECOVERYCONTROLLER_H
+#define CEPH_OSD_RECOVERYCONTROLLER_H
+
+#include <atomic>
+#include <memory>
+
+#include "common/Formatter.h"
+#include "common/Mutex.h"
+#include "include/utime.h"
+
+class CephContext;
+
+/**
+ * RecoveryController
+ *
+ * Feedback loop that sizes recovery concurrency and sleep so that the
+ * p99 latency of client ops stays under
+ * osd_recovery_controller_target_latency.  Client op latencies are
+ * sampled as ops complete, into a ring that op threads fill without
+ * taking a lock; once per tick update() looks at the samples seen since
+ * the previous tick.  Above target, concurrency is halved
+ * and sleep doubled; comfortably below it, sleep is halved first and
+ * concurrency then grows by one (AIMD).  With no target set the
+ * static osd_recovery_max_active and osd_recovery_sleep* apply.
+ */
+class RecoveryController {
+public:
+  explicit RecoveryController(CephContext *cct);
+
+  /// note the latency of a completed client op; lock-free
+  void add_client_op_latency(utime_t lat);
+
+  /**
+   * recompute the recovery throttle
+   *
+   * @param base_max_active configured osd_recovery_max_active
+   * @param base_sleep configured recovery sleep for this device type
+   */
+  void update(uint64_t base_max_active, double base_sleep);
+
+  bool is_enabled() const {
+    return enabled;
+  }
+  uint64_t get_max_active() const;
+  double get_sleep() const;
+  double get_client_p99() const;
+
+  void dump(Formatter *f) const;
+
+  /// samples kept between updates; older ones are overwritten
+  static const size_t MAX_SAMPLES = 4096;
+
+private:
+  CephContext *cct;
+  std::atomic<bool> enabled = {false};
+
+  /// ring of client op latencies (sec), slot n % MAX_SAMPLES holds
+  /// sample n; a slot being rewritten may still show an older sample
+  std::unique_ptr<std::atomic<double>[]> samples;
+  std::atomic<uint64_t> num_samples = {0};  ///< samples ever added
+
+  mutable Mutex lock;            ///< protects the rest, taken by update()
+  uint64_t last_samples = 0;     ///< num_samples as of the last update
+
+  uint64_t max_active = 0;
+  double sleep = 0;
+  double client_p99 = 0;
+  double target = 0;
+  uint64_t num_updates = 0;
+  uint64_t num_throttles = 0;
+  uint64_t num_releases = 0;
+};
+
+#endif
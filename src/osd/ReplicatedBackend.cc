@@ -239,6 +239,16 @@ void ReplicatedBackend::on_change()
     delete op.second.on_commit;
   }
   in_progress_ops.clear();
+  // the read jobs may still be running; they only touch their own
+  // AsyncRead, and their completions are dropped by the bless
+  for (auto& read : in_progress_reads) {
+    for (auto& i : read->to_read) {
+      delete i.second.second;
+    }
+    delete read->on_complete;
+  }
+  in_progress_reads.clear();
+  delta_index.clear();
   clear_recovery_state();
 }
 
@@ -257,9 +267,80 @@ void ReplicatedBackend::objects_read_async(
   const list<pair<boost::tuple<uint64_t, uint64_t, uint32_t>,
 		  pair<bufferlist*, Context*> > > &to_read,
   Context *on_complete,
-  bool fast_read)
+  bool fast_read,
+  OpRequestRef op)
 {
-  assert(0 == "async read is not used by replica pool");
+  dout(20) << __func__ << " " << hoid << " " << to_read.size()
+	   << " extents" << dendl;
+  assert(op || to_read.empty());
+  AsyncReadRef read(new AsyncRead);
+  read->hoid = hoid;
+  read->to_read = to_read;
+  read->results.resize(to_read.size());
+  read->on_complete = on_complete;
+  read->pending = to_read.size();
+  in_progress_reads.push_back(read);
+  if (to_read.empty()) {
+    finish_async_read(read);
+    return;
+  }
+
+  // each extent is read on the async read threads, and its completion
+  // is queued back to the pg's op shard like any other op work.  the
+  // queued completion holds a pg ref, so parent outlives it.
+  ObjectStore *store = this->store;
+  ObjectStore::CollectionHandle c = ch;
+  PGBackend::Listener *parent = get_parent();
+  ghobject_t oid(hoid);
+  double delay = cct->_conf->get_val<double>("osd_debug_async_read_delay");
+  unsigned n = 0;
+  for (auto& i : to_read) {
+    uint64_t off = i.first.get<0>();
+    uint64_t len = i.first.get<1>();
+    uint32_t flags = i.first.get<2>();
+    GenContext<ThreadPool::TPHandle&> *on_read =
+      parent->bless_unlocked_gencontext(
+	make_gen_lambda_context<ThreadPool::TPHandle&>(
+	  [this, read](ThreadPool::TPHandle &) {
+	    finish_async_read(read);
+	  }).release());
+    parent->queue_async_read(
+      make_gen_lambda_context<ThreadPool::TPHandle&>(
+	[store, c, oid, off, len, flags, read, n, parent, op, on_read, delay](
+	  ThreadPool::TPHandle &) mutable {
+	  if (delay > 0) {
+	    utime_t t;
+	    t.set_from_double(delay);
+	    t.sleep();
+	  }
+	  auto& result = read->results[n];
+	  result.first = store->read(c, oid, off, len, result.second, flags);
+	  parent->queue_op_context(op, on_read);
+	}).release());
+    ++n;
+  }
+}
+
+void ReplicatedBackend::finish_async_read(AsyncReadRef read)
+{
+  assert(read->pending > 0 || read->to_read.empty());
+  if (read->pending > 0)
+    --read->pending;
+  while (!in_progress_reads.empty() &&
+	 in_progress_reads.front()->pending == 0) {
+    AsyncReadRef r = in_progress_reads.front();
+    in_progress_reads.pop_front();
+    dout(20) << __func__ << " " << r->hoid << dendl;
+    auto result = r->results.begin();
+    for (auto& i : r->to_read) {
+      if (result->first >= 0) {
+	i.second.first->claim_append(result->second);
+      }
+      i.second.second->complete(result->first);
+      ++result;
+    }
+    r->on_complete->complete(0);
+  }
 }
 
 class C_OSD_OnOpCommit : public Context {
@@ -1178,6 +1259,111 @@ void ReplicatedBackend::calc_head_subsets(
 	   << "  clone_subsets " << clone_subsets << dendl;
 }
 
+/*
+ * Index the log entries appended since the last call by object, so
+ * calc_delta_subsets() only visits the entries of the object it is
+ * pushing.  Entries trimmed from the log stay in the index until the
+ * next rebuild; callers must not dereference entries at or before the
+ * log tail.
+ *
+ * The index holds pointers into the log, which is only safe because
+ * within an interval the primary's log is only appended to and trimmed
+ * at the tail.  Divergent entries are only rewound during peering, and
+ * on_change() drops the index before that.
+ */
+void ReplicatedBackend::update_delta_index()
+{
+  const pg_log_t &log = get_parent()->get_log().get_log();
+  assert(log.head >= delta_index.head);
+  if (delta_index.entries > 2 * log.log.size()) {
+    dout(20) << __func__ << " rebuilding" << dendl;
+    delta_index.clear();
+  }
+  if (log.head == delta_index.head)
+    return;
+  auto p = log.log.rbegin();
+  while (p != log.log.rend() && p->version > delta_index.head)
+    ++p;
+  for (auto q = p.base(); q != log.log.end(); ++q) {
+    delta_index.objects[q->soid].emplace_back(q->version, &*q);
+    ++delta_index.entries;
+  }
+  delta_index.head = log.head;
+}
+
+/*
+ * If every update the peer is missing for head is still in the log
+ * and recorded its modified extents, the peer can keep the rest of its
+ * current copy and we only need to push the union of those extents.
+ */
+bool ReplicatedBackend::calc_delta_subsets(
+  ObjectContextRef obc, const hobject_t& head,
+  const pg_missing_t& missing,
+  const hobject_t &last_backfill,
+  interval_set<uint64_t>& data_subset,
+  interval_set<uint64_t>& clean_subset)
+{
+  if (!cct->_conf->get_val<bool>("osd_recover_modified_extents") ||
+      !HAVE_FEATURE(get_parent()->min_peer_features(), SERVER_NAUTILUS))
+    return false;
+
+  auto m = missing.get_items().find(head);
+  if (m == missing.get_items().end() ||
+      m->second.have == eversion_t() ||
+      !(head < last_backfill))
+    return false;
+  const eversion_t have = m->second.have;
+  const pg_log_t &log = get_parent()->get_log().get_log();
+  if (have < log.tail) {
+    dout(10) << __func__ << " " << head << " have " << have
+	     << " older than log tail " << log.tail << dendl;
+    return false;
+  }
+
+  // walk head's entries after have, newest first; they must form an
+  // unbroken chain from have to the version we are pushing.  have is not
+  // older than the log tail, so none of them has been trimmed.
+  update_delta_index();
+  interval_set<uint64_t> dirty;
+  eversion_t expect = obc->obs.oi.version;
+  auto i = delta_index.objects.find(head);
+  if (i != delta_index.objects.end()) {
+    for (auto p = i->second.rbegin();
+	 p != i->second.rend() && p->first > have;
+	 ++p) {
+      const pg_log_entry_t &e = *p->second;
+      assert(e.version == p->first);
+      if (e.version != expect || !e.is_modify() || !e.extents_tracked()) {
+	dout(10) << __func__ << " " << head << " cannot use " << e << dendl;
+	return false;
+      }
+      for (auto q = e.modified_extents->begin();
+	   q != e.modified_extents->end();
+	   ++q)
+	dirty.union_insert(q.get_start(), q.get_len());
+      expect = e.prior_version;
+    }
+  }
+  if (expect != have) {
+    dout(10) << __func__ << " " << head << " log does not lead back to "
+	     << have << dendl;
+    return false;
+  }
+
+  interval_set<uint64_t> object;
+  uint64_t size = obc->obs.oi.size;
+  if (size)
+    object.insert(0, size);
+  data_subset.intersection_of(dirty, object);
+  clean_subset = object;
+  clean_subset.subtract(data_subset);
+
+  dout(10) << __func__ << " " << head << " from " << have
+	   << "  data_subset " << data_subset
+	   << "  clean_subset " << clean_subset << dendl;
+  return true;
+}
+
 void ReplicatedBackend::calc_clone_subsets(
   SnapSet& snapset, const hobject_t& soid,
   const pg_missing_t& missing,
@@ -1384,6 +1570,7 @@ int ReplicatedBackend::prep_push_to_replica(
 
   map<hobject_t, interval_set<uint64_t>> clone_subsets;
   interval_set<uint64_t> data_subset;
+  interval_set<uint64_t> clean_subset;
 
   ObcLockManager lock_manager;
   // are we doing a clone on the replica?
@@ -1420,12 +1607,19 @@ int ReplicatedBackend::prep_push_to_replica(
     SnapSetContext *ssc = obc->ssc;
     assert(ssc);
     dout(15) << "push_to_replica snapset is " << ssc->snapset << dendl;
-    calc_head_subsets(
-      obc,
-      ssc->snapset, soid, get_parent()->get_shard_missing().find(peer)->second,
-      get_parent()->get_shard_info().find(peer)->second.last_backfill,
-      data_subset, clone_subsets,
-      lock_manager);
+    const pg_missing_t &pmissing =
+      get_parent()->get_shard_missing().find(peer)->second;
+    const hobject_t &plast_backfill =
+      get_parent()->get_shard_info().find(peer)->second.last_backfill;
+    if (!calc_delta_subsets(
+	  obc, soid, pmissing, plast_backfill,
+	  data_subset, clean_subset)) {
+      calc_head_subsets(
+	obc,
+	ssc->snapset, soid, pmissing, plast_backfill,
+	data_subset, clone_subsets,
+	lock_manager);
+    }
   }
 
   return prep_push(
@@ -1435,6 +1629,7 @@ int ReplicatedBackend::prep_push_to_replica(
     oi.version,
     data_subset,
     clone_subsets,
+    clean_subset,
     pop,
     cache_dont_need,
     std::move(lock_manager));
@@ -1451,7 +1646,7 @@ int ReplicatedBackend::prep_push(ObjectContextRef obc,
 
   return prep_push(obc, soid, peer,
 	    obc->obs.oi.version, data_subset, clone_subsets,
-	    pop, cache_dont_need, ObcLockManager());
+	    interval_set<uint64_t>(), pop, cache_dont_need, ObcLockManager());
 }
 
 int ReplicatedBackend::prep_push(
@@ -1460,6 +1655,7 @@ int ReplicatedBackend::prep_push(
   eversion_t version,
   interval_set<uint64_t> &data_subset,
   map<hobject_t, interval_set<uint64_t>>& clone_subsets,
+  const interval_set<uint64_t> &clean_subset,
   PushOp *pop,
   bool cache_dont_need,
   ObcLockManager &&lock_manager)
@@ -1471,6 +1667,7 @@ int ReplicatedBackend::prep_push(
   pi.recovery_info.size = obc->obs.oi.size;
   pi.recovery_info.copy_subset = data_subset;
   pi.recovery_info.clone_subset = clone_subsets;
+  pi.recovery_info.clean_subset = clean_subset;
   pi.recovery_info.soid = soid;
   pi.recovery_info.oi = obc->obs.oi;
   pi.recovery_info.ss = pop->recovery_info.ss;
@@ -1502,7 +1699,7 @@ void ReplicatedBackend::submit_push_data(
   ObjectStore::Transaction *t)
 {
   hobject_t target_oid;
-  if (first && complete) {
+  if (first && complete && recovery_info.clean_subset.empty()) {
     target_oid = recovery_info.soid;
   } else {
     target_oid = get_parent()->get_temp_recovery_object(recovery_info.soid,
@@ -1527,6 +1724,17 @@ void ReplicatedBackend::submit_push_data(
 		      oi.expected_object_size,
 		      oi.expected_write_size,
 		      oi.alloc_hint_flags);
+
+    // delta push: start from our current copy of the object
+    for (auto p = recovery_info.clean_subset.begin();
+	 p != recovery_info.clean_subset.end();
+	 ++p) {
+      dout(15) << " clone_range " << recovery_info.soid << " "
+	       << p.get_start() << "~" << p.get_len() << dendl;
+      t->clone_range(coll, ghobject_t(recovery_info.soid),
+		     ghobject_t(target_oid),
+		     p.get_start(), p.get_len(), p.get_start());
+    }
   }
   uint64_t off = 0;
   uint32_t fadvise_flags = CEPH_OSD_OP_FLAG_FADVISE_SEQUENTIAL;
@@ -1548,7 +1756,7 @@ void ReplicatedBackend::submit_push_data(
     t->setattrs(coll, ghobject_t(target_oid), attrs);
 
   if (complete) {
-    if (!first) {
+    if (target_oid != recovery_info.soid) {
       dout(10) << __func__ << ": Removing oid "
 	       << target_oid << " from the temp collection" << dendl;
       clear_temp_obj(target_oid);
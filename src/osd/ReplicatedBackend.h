@@ -156,7 +156,8 @@ public:
     const list<pair<boost::tuple<uint64_t, uint64_t, uint32_t>,
 	       pair<bufferlist*, Context*> > > &to_read,
                Context *on_complete,
-               bool fast_read = false) override;
+               bool fast_read = false,
+               OpRequestRef op = OpRequestRef()) override;
 
 private:
   // push
@@ -309,9 +310,17 @@ private:
     eversion_t version,
     interval_set<uint64_t> &data_subset,
     map<hobject_t, interval_set<uint64_t>>& clone_subsets,
+    const interval_set<uint64_t> &clean_subset,
     PushOp *op,
     bool cache,
     ObcLockManager &&lock_manager);
+  void update_delta_index();
+  bool calc_delta_subsets(
+    ObjectContextRef obc, const hobject_t& head,
+    const pg_missing_t& missing,
+    const hobject_t &last_backfill,
+    interval_set<uint64_t>& data_subset,
+    interval_set<uint64_t>& clean_subset);
   void calc_head_subsets(
     ObjectContextRef obc, SnapSet& snapset, const hobject_t& head,
     const pg_missing_t& missing,
@@ -343,6 +352,41 @@ private:
     }
   };
   map<ceph_tid_t, InProgressOp> in_progress_ops;
+
+  /**
+   * Client reads
+   *
+   * Each extent is read by its own job on the async read threads, so
+   * the extents of one op are outstanding at once.  Results are handed
+   * back under the pg lock in issue order, which is the order
+   * PrimaryLogPG expects its reads to finish in.
+   */
+  struct AsyncRead {
+    hobject_t hoid;
+    list<pair<boost::tuple<uint64_t, uint64_t, uint32_t>,
+	      pair<bufferlist*, Context*> > > to_read;
+    vector<pair<int, bufferlist> > results; ///< per extent, from the store
+    Context *on_complete = nullptr;
+    unsigned pending = 0;                    ///< extents still being read
+  };
+  typedef ceph::shared_ptr<AsyncRead> AsyncReadRef;
+  list<AsyncReadRef> in_progress_reads;
+
+  /// log entries by object, oldest first, for calc_delta_subsets().
+  /// The version is kept alongside so that entries which have since
+  /// been trimmed from the log can be skipped without touching them.
+  /// Only valid while the log is append-only; see update_delta_index().
+  struct delta_log_index_t {
+    eversion_t head;   ///< newest log entry indexed
+    size_t entries = 0;
+    map<hobject_t, vector<pair<eversion_t, const pg_log_entry_t*>>> objects;
+    void clear() {
+      head = eversion_t();
+      entries = 0;
+      objects.clear();
+    }
+  } delta_index;
+  void finish_async_read(AsyncReadRef read);
 public:
   friend class C_OSD_OnOpCommit;
 
@@ -102,11 +102,11 @@ void Notify::do_timeout()
   timed_out = true;         // we will send the client an error code
   maybe_complete_notify();
   assert(complete);
-  set<WatchRef> _watchers;
+  std::unordered_set<WatchRef> _watchers;
   _watchers.swap(watchers);
   lock.Unlock();
 
-  for (set<WatchRef>::iterator i = _watchers.begin();
+  for (auto i = _watchers.begin();
        i != _watchers.end();
        ++i) {
     boost::intrusive_ptr<PrimaryLogPG> pg((*i)->get_pg());
@@ -158,8 +158,8 @@ void Notify::complete_watcher(WatchRef watch, bufferlist& reply_bl)
   dout(10) << "complete_watcher" << dendl;
   if (is_discarded())
     return;
-  assert(watchers.count(watch));
-  watchers.erase(watch);
+  auto erased = watchers.erase(watch);
+  assert(erased);
   notify_replies.insert(make_pair(make_pair(watch->get_watcher_gid(),
 					    watch->get_cookie()),
 				  reply_bl));
@@ -172,8 +172,8 @@ void Notify::complete_watcher_remove(WatchRef watch)
   dout(10) << __func__ << dendl;
   if (is_discarded())
     return;
-  assert(watchers.count(watch));
-  watchers.erase(watch);
+  auto erased = watchers.erase(watch);
+  assert(erased);
   maybe_complete_notify();
 }
 
@@ -187,7 +187,7 @@ void Notify::maybe_complete_notify()
     bufferlist bl;
     encode(notify_replies, bl);
     list<pair<uint64_t,uint64_t> > missed;
-    for (set<WatchRef>::iterator p = watchers.begin(); p != watchers.end(); ++p) {
+    for (auto p = watchers.begin(); p != watchers.end(); ++p) {
       missed.push_back(make_pair((*p)->get_watcher_gid(),
 				 (*p)->get_cookie()));
     }
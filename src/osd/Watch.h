@@ -16,6 +16,7 @@
 
 #include "include/memory.h"
 #include <set>
+#include <unordered_set>
 
 #include "msg/Messenger.h"
 #include "include/Context.h"
@@ -56,7 +57,9 @@ class Notify {
   bool complete;
   bool discarded;
   bool timed_out;  ///< true if the notify timed out
-  set<WatchRef> watchers;
+  /// watchers yet to ack; hashed so that each ack is O(1) however many
+  /// clients watch the object
+  std::unordered_set<WatchRef> watchers;
 
   bufferlist payload;
   uint32_t timeout;
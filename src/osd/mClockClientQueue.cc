@@ -17,6 +17,7 @@
 
 #include "osd/mClockClientQueue.h"
 #include "common/dout.h"
+#include "messages/MOSDOp.h"
 
 namespace dmc = crimson::dmclock;
 using namespace std::placeholders;
@@ -73,11 +74,26 @@ namespace ceph {
 			       std::move(item));
   }
 
-  // Enqueue op in the back of the regular queue
+  // Enqueue op in the back of the regular queue; client ops carrying
+  // the client's dmclock delta/rho are tagged with them.  Work queued
+  // later for the same op (async read completions, ec read hedges) is
+  // not, or the client would be charged for the op more than once.
   inline void mClockClientQueue::enqueue(Client cl,
 					 unsigned priority,
 					 unsigned cost,
 					 Request&& item) {
+    boost::optional<OpRequestRef> op;
+    if (item.is_client_request())
+      op = item.maybe_get_op();
+    if (op && (*op)->get_req()->get_type() == CEPH_MSG_OSD_OP) {
+      auto m = static_cast<const MOSDOp*>((*op)->get_req());
+      if (m->get_has_qos_params()) {
+	dmc::ReqParams req_params = m->get_qos_params();
+	queue.enqueue_distributed(get_inner_client(cl, item), priority, 0u,
+				  std::move(item), req_params);
+	return;
+      }
+    }
     queue.enqueue(get_inner_client(cl, item), priority, 0u, std::move(item));
   }
 
@@ -92,6 +108,15 @@ namespace ceph {
 
   // Return an op to be dispatched
   inline Request mClockClientQueue::dequeue() {
-    return queue.dequeue();
+    dmc::PhaseType phase;
+    Request ret = queue.dequeue_distributed(&phase);
+    boost::optional<OpRequestRef> op;
+    if (ret.is_client_request())
+      op = ret.maybe_get_op();
+    if (op && (*op)->get_req()->get_type() == CEPH_MSG_OSD_OP) {
+      // echoed back to the client's service tracker in the reply
+      static_cast<MOSDOp*>((*op)->get_nonconst_req())->set_qos_resp(phase);
+    }
+    return ret;
   }
 } // namespace ceph
@@ -3868,7 +3868,7 @@ void pg_log_entry_t::decode_with_checksum(bufferlist::iterator& p)
 
 void pg_log_entry_t::encode(bufferlist &bl) const
 {
-  ENCODE_START(11, 4, bl);
+  ENCODE_START(12, 4, bl);
   encode(op, bl);
   encode(soid, bl);
   encode(version, bl);
@@ -3895,12 +3895,15 @@ void pg_log_entry_t::encode(bufferlist &bl) const
   encode(extra_reqids, bl);
   if (op == ERROR)
     encode(return_code, bl);
+  encode(extents_tracked(), bl);
+  if (extents_tracked())
+    encode(*modified_extents, bl);
   ENCODE_FINISH(bl);
 }
 
 void pg_log_entry_t::decode(bufferlist::iterator &bl)
 {
-  DECODE_START_LEGACY_COMPAT_LEN(11, 4, 4, bl);
+  DECODE_START_LEGACY_COMPAT_LEN(12, 4, 4, bl);
   decode(op, bl);
   if (struct_v < 2) {
     sobject_t old_soid;
@@ -3954,6 +3957,17 @@ void pg_log_entry_t::decode(bufferlist::iterator &bl)
     decode(extra_reqids, bl);
   if (struct_v >= 11 && op == ERROR)
     decode(return_code, bl);
+  if (struct_v >= 12) {
+    bool tracked;
+    decode(tracked, bl);
+    if (tracked) {
+      auto e = std::make_shared<extents_t>();
+      decode(*e, bl);
+      modified_extents = std::move(e);
+    } else {
+      modified_extents.reset();
+    }
+  }
   DECODE_FINISH(bl);
 }
 
@@ -3996,6 +4010,8 @@ void pg_log_entry_t::dump(Formatter *f) const
     mod_desc.dump(f);
     f->close_section();
   }
+  if (extents_tracked())
+    f->dump_stream("modified_extents") << *modified_extents;
 }
 
 void pg_log_entry_t::generate_test_instances(list<pg_log_entry_t*>& o)
@@ -4008,6 +4024,12 @@ void pg_log_entry_t::generate_test_instances(list<pg_log_entry_t*>& o)
   o.push_back(new pg_log_entry_t(ERROR, oid, eversion_t(1,2), eversion_t(3,4),
 				 1, osd_reqid_t(entity_name_t::CLIENT(777), 8, 999),
 				 utime_t(8,9), -ENOENT));
+  o.push_back(new pg_log_entry_t(MODIFY, oid, eversion_t(1,2), eversion_t(3,4),
+				 1, osd_reqid_t(entity_name_t::CLIENT(777), 8, 999),
+				 utime_t(8,9), 0));
+  interval_set<uint64_t> extents;
+  extents.insert(4096, 8192);
+  o.back()->set_modified_extents(extents);
 }
 
 ostream& operator<<(ostream& out, const pg_log_entry_t& e)
@@ -5329,7 +5351,9 @@ void ObjectRecoveryProgress::dump(Formatter *f) const
 
 void ObjectRecoveryInfo::encode(bufferlist &bl, uint64_t features) const
 {
-  ENCODE_START(2, 1, bl);
+  // a peer that cannot decode clean_subset would install a partial
+  // object, so only let it decode us if there is none
+  ENCODE_START(3, clean_subset.empty() ? 1 : 3, bl);
   encode(soid, bl);
   encode(version, bl);
   encode(size, bl);
@@ -5337,13 +5361,14 @@ void ObjectRecoveryInfo::encode(bufferlist &bl, uint64_t features) const
   encode(ss, bl);
   encode(copy_subset, bl);
   encode(clone_subset, bl);
+  encode(clean_subset, bl);
   ENCODE_FINISH(bl);
 }
 
 void ObjectRecoveryInfo::decode(bufferlist::iterator &bl,
 				int64_t pool)
 {
-  DECODE_START(2, bl);
+  DECODE_START(3, bl);
   decode(soid, bl);
   decode(version, bl);
   decode(size, bl);
@@ -5351,6 +5376,8 @@ void ObjectRecoveryInfo::decode(bufferlist::iterator &bl,
   decode(ss, bl);
   decode(copy_subset, bl);
   decode(clone_subset, bl);
+  if (struct_v >= 3)
+    decode(clean_subset, bl);
   DECODE_FINISH(bl);
 
   if (struct_v < 2) {
@@ -5396,6 +5423,7 @@ void ObjectRecoveryInfo::dump(Formatter *f) const
   }
   f->dump_stream("copy_subset") << copy_subset;
   f->dump_stream("clone_subset") << clone_subset;
+  f->dump_stream("clean_subset") << clean_subset;
 }
 
 ostream& operator<<(ostream& out, const ObjectRecoveryInfo &inf)
@@ -5410,6 +5438,7 @@ ostream &ObjectRecoveryInfo::print(ostream &out) const
 	     << ", size: " << size
 	     << ", copy_subset: " << copy_subset
 	     << ", clone_subset: " << clone_subset
+	     << ", clean_subset: " << clean_subset
 	     << ", snapset: " << ss
 	     << ")";
 }
@@ -3367,6 +3367,13 @@ struct pg_log_entry_t {
   version_t user_version; // the user version for this entry
   utime_t     mtime;  // this is the _user_ mtime, mind you
   int32_t return_code; // only stored for ERRORs for dup detection
+  typedef interval_set<uint64_t, mempool::osd_pglog::map<uint64_t,uint64_t>>
+    extents_t;
+  // data extents this entry changed, relative to the object at
+  // prior_version, if they cover every data change.  most entries do
+  // not track them, so they are only allocated when set; copies of an
+  // entry share them.
+  ceph::shared_ptr<const extents_t> modified_extents;
 
   __s32      op;
   bool invalid_hash; // only when decoding sobject_t based entries
@@ -3418,6 +3425,16 @@ struct pg_log_entry_t {
     return mod_desc.requires_kraken();
   }
 
+  bool extents_tracked() const {
+    return (bool)modified_extents;
+  }
+  void set_modified_extents(const interval_set<uint64_t> &extents) {
+    auto e = std::make_shared<extents_t>();
+    for (auto p = extents.begin(); p != extents.end(); ++p)
+      e->insert(p.get_start(), p.get_len());
+    modified_extents = std::move(e);
+  }
+
   // Errors are only used for dup detection, whereas
   // the index by objects is used by recovery, copy_get,
   // and other facilities that don't expect or need to
@@ -3563,15 +3580,14 @@ public:
 
     eversion_t old_tail;
     unsigned mask = ~((~0)<<split_bits);
-    for (auto i = oldlog.begin();
-	 i != oldlog.end();
-      ) {
+    // relink the entries rather than copying them; order is preserved
+    while (!oldlog.empty()) {
+      auto i = oldlog.begin();
       if ((i->soid.get_hash() & mask) == child_pgid.m_seed) {
-	childlog.push_back(*i);
+	childlog.splice(childlog.end(), oldlog, i);
       } else {
-	log.push_back(*i);
+	log.splice(log.end(), oldlog, i);
       }
-      oldlog.erase(i++);
     }
 
     // osd_reqid is unique, so it doesn't matter if there are extra
@@ -4828,6 +4844,8 @@ struct ObjectRecoveryInfo {
   SnapSet ss;   // only populated if soid is_snap()
   interval_set<uint64_t> copy_subset;
   map<hobject_t, interval_set<uint64_t>> clone_subset;
+  // ranges the target keeps from its local copy of soid (delta recovery)
+  interval_set<uint64_t> clean_subset;
 
   ObjectRecoveryInfo() : size(0) { }
 
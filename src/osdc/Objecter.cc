@@ -3200,6 +3200,10 @@ MOSDOp *Objecter::_prepare_osd_op(Op *op)
     m->set_reqid(op->reqid);
   }
 
+  if (qos_trk) {
+    m->set_qos_params(qos_trk->get_req_params(op->target.osd));
+  }
+
   logger->inc(l_osdc_op_send);
   ssize_t sum = 0;
   for (unsigned i = 0; i < m->ops.size(); i++) {
@@ -3414,6 +3418,10 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
     // have, but that is better than doing callbacks out of order.
   }
 
+  if (qos_trk && m->get_has_qos_resp()) {
+    qos_trk->track_resp(s->osd, m->get_qos_resp());
+  }
+
   Context *onfinish = 0;
 
   int rc = m->get_result();
@@ -36,6 +36,11 @@
 #include "common/Finisher.h"
 #include "common/shunique_lock.h"
 #include "common/zipkin_trace.h"
+#include "dmclock/src/dmclock_client.h"
+
+// the following is done to unclobber _ASSERT_H so it returns to the
+// way ceph likes it
+#include "include/assert.h"
 
 #include "messages/MOSDOp.h"
 #include "osd/OSDMap.h"
@@ -1901,6 +1906,9 @@ public:
   ceph::timespan mon_timeout;
   ceph::timespan osd_timeout;
 
+  /// dmclock delta/rho per osd, if objecter_mclock_service_tracker
+  std::unique_ptr<crimson::dmclock::ServiceTracker<int>> qos_trk;
+
   MOSDOp *_prepare_osd_op(Op *op);
   void _send_op(Op *op);
   void _send_op_account(Op *op);
@@ -2040,7 +2048,11 @@ private:
     op_throttle_ops(cct, "objecter_ops", cct->_conf->objecter_inflight_ops),
     epoch_barrier(0),
     retry_writes_after_first_reply(cct->_conf->objecter_retry_writes_after_first_reply)
-  { }
+  {
+    if (cct->_conf->get_val<bool>("objecter_mclock_service_tracker")) {
+      qos_trk.reset(new crimson::dmclock::ServiceTracker<int>());
+    }
+  }
   ~Objecter() override;
 
   void init();
@@ -1466,6 +1466,31 @@ TEST(BufferList, BenchAlloc) {
   bench_bufferlist_alloc(4, 100000, 16);
 }
 
+// claim_append() many small encoded lists into one, as when building up
+// a transaction or a message front
+void bench_bufferlist_claim_append(unsigned size, unsigned num)
+{
+  utime_t start = ceph_clock_now();
+  bufferlist bl;
+  for (unsigned i = 0; i < num; ++i) {
+    // a field encoded directly, which refills the append_buffer
+    bl.append("x", 1);
+    bufferlist small;
+    small.append(buffer::create(size));
+    bl.claim_append(small);
+  }
+  utime_t end = ceph_clock_now();
+  cout << num << " claim_append of size " << size << " into "
+       << bl.get_num_buffers() << " segments in " << (end - start)
+       << std::endl;
+}
+
+TEST(BufferList, BenchClaimAppend) {
+  bench_bufferlist_claim_append(8, 1000000);
+  bench_bufferlist_claim_append(64, 1000000);
+  bench_bufferlist_claim_append(1024, 1000000);
+}
+
 TEST(BufferList, operator_equal) {
   //
   // list& operator= (const list& other)
@@ -2046,6 +2071,59 @@ TEST(BufferList, claim_append) {
   EXPECT_EQ((unsigned)0, from.length());
 }
 
+TEST(BufferList, claim_append_coalesce) {
+  bufferlist to;
+  to.append("ABC", 3);
+  ASSERT_EQ((unsigned)1, to.get_num_buffers());
+  {
+    // tiny lists are copied into the append_buffer
+    bufferlist from;
+    from.append(bufferptr("DE", 2));
+    from.append(bufferptr("F", 1));
+    to.claim_append(from);
+    EXPECT_EQ((unsigned)1, to.get_num_buffers());
+    EXPECT_EQ((unsigned)6, to.length());
+    EXPECT_EQ((unsigned)0, from.get_num_buffers());
+    EXPECT_EQ((unsigned)0, from.length());
+    EXPECT_EQ("ABCDEF", to.to_str());
+  }
+  {
+    // larger ones are linked as before
+    bufferlist from;
+    bufferptr ptr(1024);
+    ptr.zero();
+    from.append(ptr);
+    to.claim_append(from);
+    EXPECT_EQ((unsigned)2, to.get_num_buffers());
+    EXPECT_EQ(ptr.c_str(), to.back().c_str());
+    EXPECT_EQ((unsigned)(6 + 1024), to.length());
+  }
+  {
+    // so are tiny ones that do not fit in the append_buffer's tail
+    bufferlist dest;
+    dest.append("ABC", 3);
+    dest.append(std::string(dest.get_append_buffer_unused_tail_length() - 1,
+                            'x'));
+    ASSERT_EQ((unsigned)1, dest.get_append_buffer_unused_tail_length());
+    unsigned len = dest.length();
+    bufferlist from;
+    from.append(bufferptr("DE", 2));
+    dest.claim_append(from);
+    EXPECT_EQ((unsigned)2, dest.get_num_buffers());
+    EXPECT_EQ(len + 2, dest.length());
+  }
+  {
+    // a list without an append_buffer links them as before
+    bufferlist dest;
+    dest.append(bufferptr("ABC", 3));
+    bufferlist from;
+    from.append(bufferptr("DE", 2));
+    dest.claim_append(from);
+    EXPECT_EQ((unsigned)2, dest.get_num_buffers());
+    EXPECT_EQ("ABCDE", dest.to_str());
+  }
+}
+
 TEST(BufferList, claim_append_piecewise) {
   bufferlist bl, t, dst;
   auto a = bl.get_page_aligned_appender(4);
@@ -2379,6 +2457,74 @@ TEST(BufferList, splice) {
   }
 }
 
+TEST(BufferList, fragmented_offsets) {
+  // many segments of uneven length, modified between lookups
+  bufferlist bl;
+  std::string flat;
+  unsigned seed = 42;
+  for (unsigned i = 0; i < 1000; i++) {
+    unsigned len = 1 + rand_r(&seed) % 37;
+    bufferptr ptr(len);
+    for (unsigned j = 0; j < len; j++) {
+      ptr.c_str()[j] = 'a' + rand_r(&seed) % 26;
+      flat.push_back(ptr.c_str()[j]);
+    }
+    bl.push_back(ptr);
+  }
+  ASSERT_EQ(flat.size(), bl.length());
+  auto check = [&flat](const bufferlist& l) {
+    ASSERT_EQ(flat.size(), l.length());
+    bufferlist::const_iterator p = l.begin();
+    for (unsigned off = 0; off < flat.size(); off += 7) {
+      ASSERT_EQ(flat[off], l[off]);
+      p.seek(off);
+      ASSERT_EQ(off, p.get_off());
+      ASSERT_EQ(flat[off], *p);
+      unsigned len = std::min<unsigned>(50, flat.size() - off);
+      bufferlist sub;
+      sub.substr_of(l, off, len);
+      ASSERT_EQ(flat.substr(off, len), sub.to_str());
+      std::string s;
+      l.copy(off, len, s);
+      ASSERT_EQ(flat.substr(off, len), s);
+    }
+  };
+  check(bl);
+
+  // grow the last segment and add new ones
+  bl.append("XYZ", 3);
+  flat += "XYZ";
+  bl.append(bufferptr("0123456789", 10));
+  flat += "0123456789";
+  check(bl);
+
+  bufferlist other;
+  bl.splice(1000, 5000, &other);
+  EXPECT_EQ(flat.substr(1000, 5000), other.to_str());
+  flat.erase(1000, 5000);
+  check(bl);
+
+  char *c = bl.get_contiguous(2000, 300);
+  EXPECT_EQ(0, ::memcmp(flat.data() + 2000, c, 300));
+  check(bl);
+
+  bl.prepend_zero(3);
+  flat.insert(0, 3, '\0');
+  check(bl);
+
+  bufferlist copy(bl);
+  check(copy);
+  bufferlist moved(std::move(copy));
+  check(moved);
+  bufferlist swapped;
+  swapped.swap(moved);
+  check(swapped);
+  swapped.rebuild_aligned(CEPH_PAGE_SIZE);
+  check(swapped);
+  swapped.rebuild();
+  check(swapped);
+}
+
 TEST(BufferList, write) {
   std::ostringstream stream;
   bufferlist bl;
@@ -2533,6 +2679,35 @@ TEST(BufferList, crc32c_append) {
   ASSERT_EQ(bl1.crc32c(0), bl2.crc32c(0));
 }
 
+TEST(BufferList, crc32c_set) {
+  bufferptr a(4096), b(4096);
+  memset(a.c_str(), 'a', a.length());
+  memset(b.c_str(), 'b', b.length());
+  __u32 crc_a = ceph_crc32c(0, (unsigned char *)a.c_str(), a.length());
+  __u32 crc_ab = ceph_crc32c(crc_a, (unsigned char *)b.c_str(), b.length());
+
+  // a crc noted while filling the buffers is what the list reports
+  a.set_crc32c(0, crc_a);
+  b.set_crc32c(crc_a, crc_ab);
+  bufferlist bl;
+  bl.append(a);
+  bl.append(b);
+  EXPECT_EQ(crc_ab, bl.crc32c(0));
+
+  // and is adjusted for another starting value
+  bufferlist bl2;
+  bl2.append(b);
+  EXPECT_EQ(ceph_crc32c(0, (unsigned char *)b.c_str(), b.length()),
+	    bl2.crc32c(0));
+
+  // the noted value is taken as given
+  bufferptr c(a, 0, 100);
+  c.set_crc32c(0, 1234);
+  bufferlist bl3;
+  bl3.append(c);
+  EXPECT_EQ(1234u, bl3.crc32c(0));
+}
+
 TEST(BufferList, crc32c_zeros) {
   char buffer[4*1024];
   for (size_t i=0; i < sizeof(buffer); i++)
@@ -0,0 +1,172 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include "gtest/gtest.h"
+#include "common/Thread.h"
+#include "common/TrackedOp.h"
+#include "global/global_context.h"
+
+class TestOp : public TrackedOp {
+public:
+  using TrackedOp::Event;
+  using TrackedOp::get_events;
+
+  explicit TestOp(OpTracker *t) : TrackedOp(t, ceph_clock_now()) {}
+
+protected:
+  void _dump_op_descriptor_unlocked(ostream& stream) const override {
+    stream << "test_op";
+  }
+};
+
+TEST(TrackedOp, event_ring)
+{
+  OpTracker tracker(g_ceph_context, true, 1);
+  {
+    TestOp *op = new TestOp(&tracker);
+    TrackedOpRef ref(op);
+    op->tracking_start();
+    ASSERT_TRUE(op->is_sampled());
+
+    vector<TestOp::Event> ls;
+    op->get_events(&ls);
+    ASSERT_EQ(1u, ls.size());
+    ASSERT_STREQ("initiated", ls[0].c_str());
+
+    op->mark_event("one");
+    op->mark_event_string(string("two"));
+    ls.clear();
+    op->get_events(&ls);
+    ASSERT_EQ(3u, ls.size());
+    ASSERT_STREQ("one", ls[1].c_str());
+    ASSERT_STREQ("two", ls[2].c_str());
+    ASSERT_EQ("two", op->state_string());
+
+    // long dynamic names are kept whole
+    op->mark_event_string(string(100, 'x'));
+    ls.clear();
+    op->get_events(&ls);
+    ASSERT_EQ(string(100, 'x'), ls.back().c_str());
+    ASSERT_EQ(string(100, 'x'), op->get_current());
+    op->mark_event_string(string(sizeof(TestOp::Event::str) - 1, 'y'));
+    ls.clear();
+    op->get_events(&ls);
+    ASSERT_EQ(string(sizeof(TestOp::Event::str) - 1, 'y'), ls.back().c_str());
+
+    // only the most recent events are kept, oldest first
+    char buf[32];
+    vector<string> names;
+    for (int i = 0; i < 100; ++i) {
+      snprintf(buf, sizeof(buf), "e%d", i);
+      names.push_back(buf);
+    }
+    for (auto& n : names)
+      op->mark_event_string(n);
+    ls.clear();
+    op->get_events(&ls);
+    ASSERT_EQ((size_t)OPTRACKER_EVENT_RING_SIZE, ls.size());
+    for (unsigned i = 0; i < ls.size(); ++i) {
+      ASSERT_STREQ(names[100 - OPTRACKER_EVENT_RING_SIZE + i].c_str(),
+		   ls[i].c_str());
+    }
+  }
+  tracker.on_shutdown();
+}
+
+TEST(TrackedOp, concurrent_mark_event)
+{
+  OpTracker tracker(g_ceph_context, true, 1);
+  {
+    TestOp *op = new TestOp(&tracker);
+    TrackedOpRef ref(op);
+    op->tracking_start();
+
+    struct Marker : public Thread {
+      TestOp *op;
+      explicit Marker(TestOp *o) : op(o) {}
+      void *entry() override {
+	const string odd("a dynamic odd event"), even("a dynamic even event");
+	for (int i = 0; i < 10000; ++i) {
+	  op->mark_event(i % 2 ? "odd" : "even");
+	  op->mark_event_string(i % 2 ? odd : even);
+	}
+	return nullptr;
+      }
+    };
+    vector<std::unique_ptr<Marker>> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back(new Marker(op));
+      threads.back()->create("marker");
+    }
+    // readers only ever see whole events
+    for (int i = 0; i < 1000; ++i) {
+      vector<TestOp::Event> ls;
+      op->get_events(&ls);
+      ASSERT_LE(ls.size(), (size_t)OPTRACKER_EVENT_RING_SIZE);
+      for (auto& e : ls) {
+	string s = e.c_str();
+	ASSERT_TRUE(s == "initiated" || s == "odd" || s == "even" ||
+		    s == "a dynamic odd event" || s == "a dynamic even event");
+      }
+      string s = op->get_current();
+      ASSERT_TRUE(s.empty() || s == "odd" || s == "even" ||
+		  s == "a dynamic odd event" || s == "a dynamic even event");
+    }
+    for (auto& t : threads)
+      t->join();
+    vector<TestOp::Event> ls;
+    op->get_events(&ls);
+    ASSERT_EQ((size_t)OPTRACKER_EVENT_RING_SIZE, ls.size());
+  }
+  tracker.on_shutdown();
+}
+
+TEST(TrackedOp, sampling)
+{
+  OpTracker tracker(g_ceph_context, true, 1);
+  tracker.set_sample_rate(4);
+  {
+    int sampled = 0;
+    vector<TrackedOpRef> ops;
+    for (int i = 0; i < 16; ++i) {
+      TestOp *op = new TestOp(&tracker);
+      ops.emplace_back(op);
+      op->tracking_start();
+      op->mark_event("queued");
+      vector<TestOp::Event> ls;
+      op->get_events(&ls);
+      if (op->is_sampled()) {
+	++sampled;
+	ASSERT_EQ(2u, ls.size());
+      } else {
+	ASSERT_TRUE(ls.empty());
+      }
+      // the current state is kept either way, for slow op warnings
+      ASSERT_EQ("queued", op->state_string());
+      op->mark_event_string(string("waiting"));
+      ASSERT_EQ("waiting", op->state_string());
+      ASSERT_EQ("waiting", op->get_current());
+    }
+    ASSERT_EQ(4, sampled);
+
+    // all ops are still in flight, sampled or not
+    int in_flight = 0;
+    utime_t oldest;
+    tracker.set_complaint_and_threshold(0, 100);
+    tracker.visit_ops_in_flight(&oldest, [&](TrackedOp&) {
+	++in_flight;
+	return true;
+      });
+    ASSERT_EQ(16, in_flight);
+  }
+  tracker.on_shutdown();
+}
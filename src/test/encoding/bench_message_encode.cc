@@ -0,0 +1,101 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+/*
+ * Encode the per-op messages over and over, once appending to an empty
+ * payload the way encode_payload() always did, and once into a payload
+ * reserved from get_payload_bound() the way Message::encode() does now,
+ * and report the time and the buffers allocated per message.
+ *
+ *   ceph_bench_message_encode [iterations]
+ */
+
+#include <set>
+
+#include "include/types.h"
+#include "common/ceph_argparse.h"
+#include "common/ceph_time.h"
+#include "global/global_init.h"
+#include "messages/MOSDOp.h"
+#include "messages/MOSDOpReply.h"
+
+struct result_t {
+  double ns = 0;
+  double allocs = 0;
+  double bytes = 0;
+};
+
+static result_t run(Message *m, int num, bool sized)
+{
+  const uint64_t features = CEPH_FEATURES_ALL;
+  result_t r;
+  uint64_t allocs = 0, bytes = 0;
+  auto start = ceph::mono_clock::now();
+  for (int i = 0; i < num; i++) {
+    m->clear_payload();
+    if (sized)
+      m->get_payload().reserve(m->get_payload_bound(features));
+    m->encode_payload(features);
+
+    std::set<buffer::raw*> raws;
+    for (auto& p : m->get_payload().buffers()) {
+      if (raws.insert(p.get_raw()).second)
+	bytes += p.raw_length();
+    }
+    allocs += raws.size();
+  }
+  auto dur = ceph::mono_clock::now() - start;
+  r.ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count() / num;
+  r.allocs = (double)allocs / num;
+  r.bytes = (double)bytes / num;
+  return r;
+}
+
+static void report(const char *name, Message *m, int num)
+{
+  result_t a = run(m, num, false);
+  result_t s = run(m, num, true);
+  cout << name << " (" << m->get_payload().length() << " byte payload)\n"
+       << "  appended: " << a.ns << " ns/op, " << a.allocs << " allocs, "
+       << a.bytes << " bytes\n"
+       << "  sized:    " << s.ns << " ns/op, " << s.allocs << " allocs, "
+       << s.bytes << " bytes" << std::endl;
+}
+
+int main(int argc, const char **argv)
+{
+  int num = argc > 1 ? atoi(argv[1]) : 1000000;
+
+  vector<const char*> args;
+  argv_to_vec(argc, argv, args);
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+
+  hobject_t hoid(object_t("rbd_data.1234567890ab.0000000000000001"),
+		 "", CEPH_NOSNAP, 0x12345678, 1, "");
+  spg_t pgid(pg_t(0x78, 1));
+
+  MOSDOp *op = new MOSDOp(1, 1, hoid, pgid, 100,
+			  CEPH_OSD_FLAG_WRITE | CEPH_OSD_FLAG_ONDISK,
+			  CEPH_FEATURES_ALL);
+  bufferlist bl;
+  bl.append_zero(4096);
+  op->write(0, 4096, bl);
+  report("MOSDOp write", op, num);
+
+  MOSDOp *op4 = new MOSDOp(1, 2, hoid, pgid, 100, CEPH_OSD_FLAG_READ,
+			   CEPH_FEATURES_ALL);
+  for (int i = 0; i < 4; i++)
+    op4->add_simple_op(CEPH_OSD_OP_READ, i * 4096, 4096);
+  report("MOSDOp 4 reads", op4, num);
+
+  MOSDOpReply *reply = new MOSDOpReply(op, 0, 100, CEPH_OSD_FLAG_ONDISK,
+				       true);
+  report("MOSDOpReply", reply, num);
+
+  reply->put();
+  op4->put();
+  op->put();
+  return 0;
+}
@@ -108,6 +108,7 @@ TYPE(ECSubReadReply)
 TYPE_NONDETERMINISTIC(ExplicitHashHitSet)
 TYPE_NONDETERMINISTIC(ExplicitObjectHitSet)
 TYPE(BloomHitSet)
+TYPE(CountMinHitSet)
 TYPE_NONDETERMINISTIC(HitSet)   // because some subclasses are
 TYPE(HitSet::Params)
 
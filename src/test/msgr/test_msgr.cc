@@ -21,6 +21,9 @@
 #include <time.h>
 #include "common/Mutex.h"
 #include "common/Cond.h"
+#include "common/Throttle.h"
+#include "common/perf_counters.h"
+#include "include/mempool.h"
 #include "common/ceph_argparse.h"
 #include "global/global_init.h"
 #include "msg/Dispatcher.h"
@@ -28,6 +31,7 @@
 #include "msg/Message.h"
 #include "msg/Messenger.h"
 #include "msg/Connection.h"
+#include "msg/async/BufferPool.h"
 #include "messages/MPing.h"
 #include "messages/MCommand.h"
 
@@ -1162,16 +1166,13 @@ bool SyntheticDispatcher::ms_handle_reset(Connection *con) {
   return true;
 }
 
-TEST_P(MessengerTest, SyntheticStressTest) {
-  SyntheticWorkload test_msg(8, 32, GetParam(), 100,
-                             Messenger::Policy::stateful_server(0),
-                             Messenger::Policy::lossless_client(0));
+static void run_synthetic_workload(SyntheticWorkload &test_msg, int num_ops) {
   for (int i = 0; i < 100; ++i) {
     if (!(i % 10)) lderr(g_ceph_context) << "seeding connection " << i << dendl;
     test_msg.generate_connection();
   }
   gen_type rng(time(NULL));
-  for (int i = 0; i < 5000; ++i) {
+  for (int i = 0; i < num_ops; ++i) {
     if (!(i % 10)) {
       lderr(g_ceph_context) << "Op " << i << ": " << dendl;
       test_msg.print_internal_state();
@@ -1188,6 +1189,36 @@ TEST_P(MessengerTest, SyntheticStressTest) {
       usleep(rand() % 1000 + 500);
     }
   }
+}
+
+// summed over every messenger worker in the process
+static uint64_t get_compressed_messages_sent() {
+  uint64_t sent = 0;
+  g_ceph_context->get_perfcounters_collection()->with_counters(
+    [&sent](const PerfCountersCollection::CounterMap &counters) {
+      const string suffix = ".msgr_send_compressed_messages";
+      for (auto &c : counters) {
+        if (c.first.size() > suffix.size() &&
+            c.first.compare(c.first.size() - suffix.size(), suffix.size(),
+                            suffix) == 0)
+          sent += c.second.data->u64;
+      }
+    });
+  return sent;
+}
+
+static void set_compress_config(const char *peer_types, const char *min_size) {
+  g_ceph_context->_conf->_clear_safe_to_start_threads();
+  g_ceph_context->_conf->set_val("ms_compress_peer_types", peer_types);
+  g_ceph_context->_conf->set_val("ms_compress_min_size", min_size);
+  g_ceph_context->_conf->set_safe_to_start_threads();
+}
+
+TEST_P(MessengerTest, SyntheticStressTest) {
+  SyntheticWorkload test_msg(8, 32, GetParam(), 100,
+                             Messenger::Policy::stateful_server(0),
+                             Messenger::Policy::lossless_client(0));
+  run_synthetic_workload(test_msg, 5000);
   test_msg.wait_for_done();
 }
 
@@ -1220,6 +1251,44 @@ TEST_P(MessengerTest, SyntheticStressTest1) {
   test_msg.wait_for_done();
 }
 
+TEST_P(MessengerTest, SyntheticCompressTest) {
+  set_compress_config("osd client", "1024");
+  uint64_t compressed = get_compressed_messages_sent();
+  {
+    SyntheticWorkload test_msg(8, 32, GetParam(), 100,
+                               Messenger::Policy::stateful_server(0),
+                               Messenger::Policy::lossless_client(0));
+    run_synthetic_workload(test_msg, 1000);
+    // only the async messenger negotiates compression
+    if (string(GetParam()).find("async") == 0)
+      EXPECT_GT(get_compressed_messages_sent(), compressed);
+    test_msg.wait_for_done();
+  }
+  set_compress_config("", "8192");
+}
+
+TEST_P(MessengerTest, SyntheticCompressThrottleTest) {
+  // the server charges its byte throttler for the wire length of each
+  // message and the message puts back the decompressed length; they must
+  // balance or Throttle::put() asserts.
+  Throttle byte_throttler(g_ceph_context, "compress_throttle_bytes",
+                          64 * 1024 * 1024);
+  set_compress_config("osd client", "1024");
+  uint64_t compressed = get_compressed_messages_sent();
+  Messenger::Policy srv_policy = Messenger::Policy::stateful_server(0);
+  srv_policy.throttler_bytes = &byte_throttler;
+  {
+    SyntheticWorkload test_msg(8, 32, GetParam(), 100, srv_policy,
+                               Messenger::Policy::lossless_client(0));
+    run_synthetic_workload(test_msg, 1000);
+    if (string(GetParam()).find("async") == 0)
+      EXPECT_GT(get_compressed_messages_sent(), compressed);
+    test_msg.wait_for_done();
+  }
+  ASSERT_EQ(0, byte_throttler.get_current());
+  set_compress_config("", "8192");
+}
+
 
 TEST_P(MessengerTest, SyntheticInjectTest) {
   uint64_t dispatch_throttle_bytes = g_ceph_context->_conf->ms_dispatch_throttle_bytes;
@@ -1515,6 +1584,30 @@ TEST(DummyTest, ValueParameterizedTestsAreNotSupportedOnThisPlatform) {}
 
 #endif
 
+TEST(SmallBufferArena, KeptFrontsDoNotPinChunks) {
+  size_t base = mempool::msgr::allocated_bytes();
+  bufferlist kept;
+  {
+    SmallBufferArena arena;
+    // op fronts share a chunk, accounted to the msgr mempool
+    bufferptr a = arena.get(CEPH_MSG_OSD_OP, 300);
+    bufferptr b = arena.get(CEPH_MSG_OSD_OPREPLY, 200);
+    ASSERT_EQ(a.raw_c_str(), b.raw_c_str());
+    ASSERT_EQ(base + SmallBufferArena::CHUNK_SIZE,
+              mempool::msgr::allocated_bytes());
+
+    // a front that may be decoded by reference gets a buffer of its own
+    bufferptr c = arena.get(MSG_OSD_REPOP, 300);
+    ASSERT_NE(a.raw_c_str(), c.raw_c_str());
+    ASSERT_EQ(300u, c.raw_length());
+    kept.append(c, 10, 20);
+  }
+  // the arena and the op fronts are gone; what was kept of the other
+  // front holds no chunk
+  ASSERT_EQ(20u, kept.length());
+  ASSERT_EQ(base, mempool::msgr::allocated_bytes());
+}
+
 
 int main(int argc, char **argv) {
   vector<const char*> args;
@@ -5,7 +5,9 @@
 
 #include <semaphore.h>
 #include <errno.h>
+#include <chrono>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <iostream>
 #include <string>
@@ -28,6 +30,25 @@ public:
     }
 };
 
+class FanoutWatchCtx : public WatchCtx2
+{
+  IoCtx &ioctx;
+  std::string oid;
+public:
+  FanoutWatchCtx(IoCtx &ioctx, const std::string &oid)
+    : ioctx(ioctx), oid(oid) {}
+  void handle_notify(uint64_t notify_id, uint64_t cookie,
+		     uint64_t notifier_id, bufferlist& bl) override
+  {
+    bufferlist reply;
+    ioctx.notify_ack(oid, notify_id, cookie, reply);
+  }
+  void handle_error(uint64_t cookie, int err) override
+  {
+    std::cerr << "watch " << cookie << " error " << err << std::endl;
+  }
+};
+
 #pragma GCC diagnostic ignored "-Wpragmas"
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -75,6 +96,96 @@ test_loop(Rados &cluster, std::string pool_name, std::string obj_name)
 #pragma GCC diagnostic pop
 #pragma GCC diagnostic warning "-Wpragmas"
 
+/*
+ * Many clients, each with its own connection, watch one object (an rbd
+ * header of a golden image, an rgw control object) while one client
+ * notifies it over and over.  Reports how long each notify takes to be
+ * delivered to and acked by every watcher.
+ */
+void
+test_fanout(Rados &cluster, const std::string &pool_name,
+	    const std::string &obj_name, int num_watchers, int num_notifies)
+{
+  int ret;
+  cluster.pool_create(pool_name.c_str());
+  IoCtx ioctx;
+  ret = cluster.ioctx_create(pool_name.c_str(), ioctx);
+  if (ret < 0) {
+    std::cerr << "ioctx_create " << pool_name << " failed with " << ret << std::endl;
+    exit(1);
+  }
+  ioctx.application_enable("rados", true);
+  ret = ioctx.create(obj_name, false);
+  if (ret < 0) {
+    std::cerr << "create failed with " << ret << std::endl;
+    exit(1);
+  }
+
+  struct Watcher {
+    Rados rados;
+    IoCtx ioctx;
+    std::unique_ptr<FanoutWatchCtx> ctx;
+    uint64_t handle = 0;
+  };
+  std::vector<std::unique_ptr<Watcher>> watchers;
+  for (int i = 0; i < num_watchers; ++i) {
+    std::unique_ptr<Watcher> w(new Watcher);
+    ret = w->rados.init_with_context(cluster.cct());
+    if (!ret)
+      ret = w->rados.connect();
+    if (!ret)
+      ret = w->rados.ioctx_create(pool_name.c_str(), w->ioctx);
+    if (ret < 0) {
+      std::cerr << "watcher " << i << " connect failed with " << ret << std::endl;
+      exit(1);
+    }
+    w->ctx.reset(new FanoutWatchCtx(w->ioctx, obj_name));
+    ret = w->ioctx.watch2(obj_name, &w->handle, w->ctx.get());
+    if (ret < 0) {
+      std::cerr << "watcher " << i << " watch failed with " << ret << std::endl;
+      exit(1);
+    }
+    watchers.push_back(std::move(w));
+  }
+  std::cerr << num_watchers << " watchers registered" << std::endl;
+
+  bufferlist payload;
+  payload.append(std::string(128, 'x'));
+  double total = 0, worst = 0;
+  int timeouts = 0;
+  for (int i = 0; i < num_notifies; ++i) {
+    bufferlist reply;
+    auto start = std::chrono::steady_clock::now();
+    ret = ioctx.notify2(obj_name, payload, 30000, &reply);
+    std::chrono::duration<double> lat = std::chrono::steady_clock::now() - start;
+    if (ret == -ETIMEDOUT) {
+      ++timeouts;
+    } else if (ret < 0) {
+      std::cerr << "notify failed with " << ret << std::endl;
+      exit(1);
+    }
+    total += lat.count();
+    worst = std::max(worst, lat.count());
+  }
+  std::cout << num_watchers << " watchers, " << num_notifies << " notifies: "
+	    << "avg " << (total / num_notifies) * 1000 << " ms, "
+	    << "max " << worst * 1000 << " ms, "
+	    << num_notifies / total << " notifies/sec, "
+	    << timeouts << " timed out" << std::endl;
+
+  for (auto& w : watchers) {
+    w->ioctx.unwatch2(w->handle);
+    w->ioctx.close();
+    w->rados.shutdown();
+  }
+  ioctx.close();
+  ret = cluster.pool_delete(pool_name.c_str());
+  if (ret < 0) {
+    std::cerr << "pool_delete failed with " << ret << std::endl;
+    exit(1);
+  }
+}
+
 void
 test_replicated(Rados &cluster, std::string pool_name, const std::string &obj_name)
 {
@@ -117,8 +228,10 @@ test_erasure(Rados &cluster, const std::string &pool_name, const std::string &ob
 
 int main(int args, char **argv)
 {
-  if (args != 3 && args != 4) {
+  if (args < 3 || args > 6) {
     std::cerr << "Error: " << argv[0] << " [ec|rep] pool_name obj_name" << std::endl;
+    std::cerr << "       " << argv[0] << " fanout pool_name obj_name"
+	      << " [watchers] [notifies]" << std::endl;
     return 1;
   }
 
@@ -136,10 +249,16 @@ int main(int args, char **argv)
   std::cerr << "Test type " << type << std::endl;
   std::cerr << "pool_name, obj_name are " << pool_name << ", " << obj_name << std::endl;
 
-  if (type != "ec" && type != "rep") {
-    std::cerr << "Error: " << argv[0] << " Invalid arg must be 'ec' or 'rep' saw " << type << std::endl;
+  if (type != "ec" && type != "rep" && type != "fanout") {
+    std::cerr << "Error: " << argv[0] << " Invalid arg must be 'ec', 'rep' or 'fanout' saw " << type << std::endl;
+    return 1;
+  }
+  if (type != "fanout" && args > 4) {
+    std::cerr << "Error: " << argv[0] << " too many args for " << type << std::endl;
     return 1;
   }
+  int num_watchers = args > 4 ? atoi(argv[4]) : 64;
+  int num_notifies = args > 5 ? atoi(argv[5]) : 1000;
 
   char *id = getenv("CEPH_CLIENT_ID");
   if (id) std::cerr << "Client id is: " << id << std::endl;
@@ -169,6 +288,8 @@ int main(int args, char **argv)
     test_replicated(cluster, pool_name, obj_name);
   else if (type == "ec")
     test_erasure(cluster, pool_name, obj_name);
+  else
+    test_fanout(cluster, pool_name, obj_name, num_watchers, num_notifies);
 
   sem_destroy(&sem);
   return 0;
@@ -58,3 +58,97 @@ TEST(ECUtil, stripe_info_t)
             make_pair((uint64_t)0, 2*swidth));
 }
 
+
+TEST(ECUtil, offset_len_to_data_chunks)
+{
+  const uint64_t swidth = 4096;
+  const uint64_t ssize = 4;
+
+  ECUtil::stripe_info_t s(ssize, swidth);
+  const uint64_t csize = s.get_chunk_size();
+
+  set<int> chunks;
+  s.offset_len_to_data_chunks(make_pair((uint64_t)0, (uint64_t)0), &chunks);
+  ASSERT_TRUE(chunks.empty());
+
+  chunks.clear();
+  s.offset_len_to_data_chunks(make_pair(csize, csize), &chunks);
+  ASSERT_EQ(chunks, set<int>({1}));
+
+  chunks.clear();
+  s.offset_len_to_data_chunks(make_pair(swidth + 10, csize), &chunks);
+  ASSERT_EQ(chunks, set<int>({0, 1}));
+
+  // wraps into the next stripe
+  chunks.clear();
+  s.offset_len_to_data_chunks(make_pair(swidth - 10, (uint64_t)20), &chunks);
+  ASSERT_EQ(chunks, set<int>({0, 3}));
+
+  // less than a stripe long but touching every chunk
+  chunks.clear();
+  s.offset_len_to_data_chunks(make_pair((uint64_t)10, swidth - 5), &chunks);
+  ASSERT_EQ(chunks, set<int>({0, 1, 2, 3}));
+
+  chunks.clear();
+  s.offset_len_to_data_chunks(make_pair((uint64_t)0, 3 * swidth), &chunks);
+  ASSERT_EQ(chunks, set<int>({0, 1, 2, 3}));
+}
+
+TEST(ECUtil, gather_extent)
+{
+  const uint64_t swidth = 32;
+  const uint64_t ssize = 4;
+  ECUtil::stripe_info_t s(ssize, swidth);
+  const uint64_t csize = s.get_chunk_size();
+
+  // two stripes of logical data, byte i holds i
+  string logical;
+  for (unsigned i = 0; i < 2 * swidth; ++i)
+    logical.push_back((char)i);
+
+  // lay the data out over the shards the way the encoder does, with
+  // data chunk c stored on shard mapping[c]
+  auto shard_out = [&](const vector<int> &mapping, uint64_t from_stripe) {
+    map<int, bufferlist> decoded;
+    for (uint64_t off = from_stripe * swidth; off < logical.size();
+	 off += csize) {
+      int chunk = (off % swidth) / csize;
+      int shard = mapping.empty() ? chunk : mapping[chunk];
+      decoded[shard].append(logical.substr(off, csize));
+    }
+    return decoded;
+  };
+  auto gather = [&](const vector<int> &mapping, map<int, bufferlist> &decoded,
+		    uint64_t stripe_off, uint64_t off, uint64_t len) {
+    bufferlist bl;
+    ECUtil::gather_extent(s, mapping, decoded, stripe_off, off, len, &bl);
+    return bl.to_str();
+  };
+
+  vector<int> identity;
+  map<int, bufferlist> decoded = shard_out(identity, 0);
+  ASSERT_EQ(gather(identity, decoded, 0, 10, 40), logical.substr(10, 40));
+  ASSERT_EQ(gather(identity, decoded, 0, 0, 2 * swidth), logical);
+
+  // a read within one chunk needs only that chunk's shard
+  map<int, bufferlist> one;
+  one[1] = decoded[1];
+  ASSERT_EQ(gather(identity, one, 0, csize + 1, csize - 2),
+	    logical.substr(csize + 1, csize - 2));
+  ASSERT_EQ(gather(identity, one, 0, swidth + csize, csize),
+	    logical.substr(swidth + csize, csize));
+
+  // remapped chunks
+  vector<int> mapping = {2, 3, 0, 1};
+  map<int, bufferlist> remapped = shard_out(mapping, 0);
+  ASSERT_EQ(gather(mapping, remapped, 0, 3, 50), logical.substr(3, 50));
+
+  // shards holding only the second stripe
+  map<int, bufferlist> second = shard_out(identity, 1);
+  ASSERT_EQ(gather(identity, second, swidth, swidth + 5, 20),
+	    logical.substr(swidth + 5, 20));
+
+  // reading past the end of the shards stops short
+  ASSERT_EQ(gather(identity, decoded, 0, swidth + 20, 2 * swidth),
+	    logical.substr(swidth + 20));
+}
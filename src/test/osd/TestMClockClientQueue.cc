@@ -6,6 +6,8 @@
 #include "global/global_init.h"
 #include "common/common_init.h"
 
+#include "messages/MOSDOp.h"
+#include "osd/OpRequest.h"
 #include "osd/mClockClientQueue.h"
 
 
@@ -182,3 +184,45 @@ TEST_F(MClockClientQueueTest, TestRemoveByClass) {
   r = q.dequeue();
   ASSERT_EQ(104u, r.get_map_epoch());
 }
+
+
+struct NoopOpContext : public GenContext<ThreadPool::TPHandle&> {
+  void finish(ThreadPool::TPHandle&) override {}
+};
+
+TEST_F(MClockClientQueueTest, TestOpContextNotQosTagged) {
+  OpTracker tracker(g_ceph_context, false, 1);
+  {
+    hobject_t hoid(object_t("foo"), "", CEPH_NOSNAP, 0x12345678, 1, "");
+    spg_t pgid(pg_t(0x78, 1));
+    MOSDOp *m = new MOSDOp(1, 2, hoid, pgid, 100, CEPH_OSD_FLAG_READ,
+			   CEPH_FEATURES_ALL);
+    m->set_qos_params(crimson::dmclock::ReqParams(5, 2));
+    m->set_qos_resp(crimson::dmclock::PhaseType::priority);
+    OpRequestRef op = tracker.create_request<OpRequest, Message*>(m);
+
+    // work queued on behalf of the op is neither charged to the client
+    // again nor reports its phase back
+    q.enqueue(client1, 12, 0,
+	      Request(OpQueueItem(
+		unique_ptr<OpQueueItem::OpQueueable>(
+		  new PGOpContext(pgid, op, new NoopOpContext, 100)),
+		0, 12, utime_t(), client1, 100)));
+    Request r = q.dequeue();
+    ASSERT_EQ(100u, r.get_map_epoch());
+    ASSERT_FALSE(r.is_client_request());
+    ASSERT_EQ(crimson::dmclock::PhaseType::priority, m->get_qos_resp());
+
+    // the op itself is, and with the default client op reservation its
+    // first request is served in the reservation phase
+    q.enqueue(client1, 12, 0,
+	      Request(OpQueueItem(
+		unique_ptr<OpQueueItem::OpQueueable>(new PGOpItem(pgid, op)),
+		0, 12, utime_t(), client1, 101)));
+    r = q.dequeue();
+    ASSERT_EQ(101u, r.get_map_epoch());
+    ASSERT_TRUE(r.is_client_request());
+    ASSERT_EQ(crimson::dmclock::PhaseType::reservation, m->get_qos_resp());
+  }
+  tracker.on_shutdown();
+}
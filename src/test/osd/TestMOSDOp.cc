@@ -0,0 +1,119 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include "gtest/gtest.h"
+#include "global/global_context.h"
+#include "messages/MOSDOp.h"
+#include "messages/MOSDOpReply.h"
+
+// a peer that predates the dmclock params in v9
+static const uint64_t PRE_NAUTILUS_FEATURES =
+  CEPH_FEATURES_ALL & ~CEPH_FEATURE_SERVER_NAUTILUS;
+
+static MOSDOp *make_op(bool qos)
+{
+  hobject_t hoid(object_t("rbd_data.1234567890ab.0000000000000001"),
+		 "", CEPH_NOSNAP, 0x12345678, 1, "");
+  spg_t pgid(pg_t(0x78, 1));
+  MOSDOp *m = new MOSDOp(1, 2, hoid, pgid, 100,
+			 CEPH_OSD_FLAG_WRITE | CEPH_OSD_FLAG_ONDISK,
+			 CEPH_FEATURES_ALL);
+  bufferlist bl;
+  bl.append_zero(4096);
+  m->write(0, 4096, bl);
+  if (qos)
+    m->set_qos_params(crimson::dmclock::ReqParams(5, 2));
+  m->set_qos_resp(crimson::dmclock::PhaseType::reservation);
+  return m;
+}
+
+template<typename T>
+static T *round_trip(T *m, uint64_t features)
+{
+  bufferlist bl;
+  encode_message(m, features, bl);
+  m->put();
+  auto p = bl.begin();
+  Message *d = decode_message(g_ceph_context, 0, p);
+  EXPECT_NE(nullptr, d);
+  return static_cast<T*>(d);
+}
+
+TEST(MOSDOp, v8_without_qos)
+{
+  MOSDOp *d = round_trip(make_op(false), CEPH_FEATURES_ALL);
+  ASSERT_TRUE(d);
+  EXPECT_EQ(8, d->get_header().version);
+  EXPECT_FALSE(d->get_has_qos_params());
+  EXPECT_EQ(2u, d->get_tid());
+  EXPECT_EQ(100u, d->get_map_epoch());
+  ASSERT_TRUE(d->finish_decode());
+  ASSERT_EQ(1u, d->ops.size());
+  EXPECT_EQ(4096u, d->ops[0].op.extent.length);
+  d->put();
+}
+
+TEST(MOSDOp, v8_to_pre_nautilus)
+{
+  MOSDOp *d = round_trip(make_op(true), PRE_NAUTILUS_FEATURES);
+  ASSERT_TRUE(d);
+  EXPECT_EQ(8, d->get_header().version);
+  EXPECT_FALSE(d->get_has_qos_params());
+  EXPECT_EQ(100u, d->get_map_epoch());
+  ASSERT_TRUE(d->finish_decode());
+  ASSERT_EQ(1u, d->ops.size());
+  EXPECT_EQ(4096u, d->ops[0].op.extent.length);
+  d->put();
+}
+
+TEST(MOSDOp, v9)
+{
+  MOSDOp *d = round_trip(make_op(true), CEPH_FEATURES_ALL);
+  ASSERT_TRUE(d);
+  EXPECT_EQ(9, d->get_header().version);
+  ASSERT_TRUE(d->get_has_qos_params());
+  EXPECT_EQ(5u, d->get_qos_params().delta);
+  EXPECT_EQ(2u, d->get_qos_params().rho);
+  EXPECT_EQ(100u, d->get_map_epoch());
+  ASSERT_TRUE(d->finish_decode());
+  ASSERT_EQ(1u, d->ops.size());
+  EXPECT_EQ(4096u, d->ops[0].op.extent.length);
+  d->put();
+}
+
+TEST(MOSDOpReply, v8_to_pre_nautilus)
+{
+  MOSDOp *op = make_op(true);
+  MOSDOpReply *r = new MOSDOpReply(op, 0, 100, CEPH_OSD_FLAG_ONDISK, true);
+  op->put();
+  ASSERT_TRUE(r->get_has_qos_resp());
+  MOSDOpReply *d = round_trip(r, PRE_NAUTILUS_FEATURES);
+  ASSERT_TRUE(d);
+  EXPECT_EQ(8, d->get_header().version);
+  EXPECT_FALSE(d->get_has_qos_resp());
+  EXPECT_EQ(100u, d->get_map_epoch());
+  d->put();
+}
+
+TEST(MOSDOpReply, v9)
+{
+  MOSDOp *op = make_op(true);
+  MOSDOpReply *r = new MOSDOpReply(op, 0, 100, CEPH_OSD_FLAG_ONDISK, true);
+  op->put();
+  MOSDOpReply *d = round_trip(r, CEPH_FEATURES_ALL);
+  ASSERT_TRUE(d);
+  EXPECT_EQ(9, d->get_header().version);
+  ASSERT_TRUE(d->get_has_qos_resp());
+  EXPECT_EQ(crimson::dmclock::PhaseType::reservation, d->get_qos_resp());
+  EXPECT_EQ(100u, d->get_map_epoch());
+  d->put();
+}
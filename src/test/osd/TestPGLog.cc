@@ -2672,6 +2672,85 @@ TEST_F(PGLogMergeDupsTest, Superset) {
 }
 
 
+class PGLogTrimPersistTest : protected PGLog,
+			     public PGLogTestBase,
+			     public StoreTestFixture {
+public:
+  PGLogTrimPersistTest() : PGLog(g_ceph_context), StoreTestFixture("memstore") { }
+
+  void SetUp() override {
+    StoreTestFixture::SetUp();
+    ObjectStore::Transaction t;
+    test_coll = coll_t(spg_t(pg_t(1, 1)));
+    auto ch = store->create_new_collection(test_coll);
+    t.create_collection(test_coll, 0);
+    store->queue_transaction(ch, std::move(t));
+
+    hobject_t hoid;
+    hoid.pool = 1;
+    hoid.oid = "log";
+    log_oid = ghobject_t(hoid);
+  }
+
+  void TearDown() override {
+    clear();
+    StoreTestFixture::TearDown();
+  }
+
+  void write_log() {
+    ObjectStore::Transaction t;
+    map<string, bufferlist> km;
+    write_log_and_missing(t, &km, test_coll, log_oid, false);
+    if (!km.empty()) {
+      t.omap_setkeys(test_coll, log_oid, km);
+    }
+    auto ch = store->open_collection(test_coll);
+    ASSERT_EQ(0u, store->queue_transaction(ch, std::move(t)));
+  }
+
+  void read_log() {
+    clear();
+    auto ch = store->open_collection(test_coll);
+    ostringstream err;
+    read_log_and_missing(store.get(), ch, log_oid, info, err, false);
+  }
+
+  coll_t test_coll;
+  ghobject_t log_oid;
+  pg_info_t info;
+};
+
+TEST_F(PGLogTrimPersistTest, TrimmedKeysRemoved) {
+  for (unsigned i = 1; i <= 10; ++i) {
+    add(mk_ple_mod(mk_obj(i), mk_evt(10, i), mk_evt(10, i - 1),
+		   osd_reqid_t(entity_name_t::CLIENT(777), 8, i)));
+  }
+  log.skip_can_rollback_to_to_head();
+  info.last_update = info.last_complete = mk_evt(10, 10);
+  write_log();
+
+  trim(mk_evt(10, 6), info);
+  write_log();
+  read_log();
+  ASSERT_EQ(4u, log.log.size());
+  EXPECT_EQ(mk_evt(10, 7), log.log.front().version);
+  EXPECT_EQ(6u, log.dups.size());
+
+  // trim the dups as well
+  string tracked = std::to_string(
+    g_ceph_context->_conf->osd_pg_log_dups_tracked);
+  g_ceph_context->_conf->set_val_or_die("osd_pg_log_dups_tracked", "2");
+  log.skip_can_rollback_to_to_head();
+  trim(mk_evt(10, 8), info);
+  write_log();
+  g_ceph_context->_conf->set_val_or_die("osd_pg_log_dups_tracked", tracked);
+  read_log();
+  ASSERT_EQ(2u, log.log.size());
+  EXPECT_EQ(mk_evt(10, 9), log.log.front().version);
+  ASSERT_EQ(1u, log.dups.size());
+  EXPECT_EQ(mk_evt(10, 8), log.dups.front().version);
+}
+
 struct PGLogTrimTest :
   public ::testing::Test,
   public PGLogTestBase,
@@ -2859,6 +2938,32 @@ TEST_F(PGLogTrimTest, TestTrimAll)
   EXPECT_EQ(0u, trimmed_dups.size());
 }
 
+TEST_F(PGLogTrimTest, TestTrimKeepsObjectIndex)
+{
+  SetUp(1, 2, 20);
+  PGLog::IndexedLog log;
+  log.head = mk_evt(24, 0);
+  log.skip_can_rollback_to_to_head();
+  log.head = mk_evt(9, 0);
+  log.index();
+
+  hobject_t obj1 = mk_obj(1);
+  hobject_t obj2 = mk_obj(2);
+  log.add(mk_ple_mod(obj1, mk_evt(10, 100), mk_evt(8, 70)));
+  log.add(mk_ple_mod(obj2, mk_evt(15, 150), mk_evt(10, 100)));
+  log.add(mk_ple_mod(obj1, mk_evt(19, 160), mk_evt(10, 100)));
+
+  log.trim(cct, mk_evt(15, 150), nullptr, nullptr, nullptr);
+
+  EXPECT_EQ(1u, log.log.size());
+  EXPECT_EQ(0u, log.objects.count(obj2));
+  auto p = log.objects.find(obj1);
+  ASSERT_NE(log.objects.end(), p);
+  EXPECT_EQ(mk_evt(19, 160), p->second->version);
+  // the key must refer to the surviving entry, not a trimmed one
+  EXPECT_EQ(&p->second->soid, &p->first.get());
+}
+
 
 TEST_F(PGLogTrimTest, TestGetRequest) {
   SetUp(1, 2, 20);
@@ -0,0 +1,131 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "global/global_init.h"
+#include "global/global_context.h"
+#include "common/common_init.h"
+#include "common/config.h"
+
+#include "osd/RecoveryController.h"
+
+
+int main(int argc, char **argv) {
+  std::vector<const char*> args(argv, argv+argc);
+  auto cct = global_init(nullptr, args, CEPH_ENTITY_TYPE_OSD,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+  common_init_finish(g_ceph_context);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class RecoveryControllerTest : public testing::Test {
+public:
+  RecoveryController rc;
+
+  RecoveryControllerTest() : rc(g_ceph_context) {}
+
+  void SetUp() override {
+    g_ceph_context->_conf->set_val("osd_recovery_controller_target_latency",
+				   "0.1");
+    g_ceph_context->_conf->set_val("osd_recovery_controller_max_active", "8");
+    g_ceph_context->_conf->set_val("osd_recovery_controller_max_sleep", "0.5");
+    g_ceph_context->_conf->set_val("osd_recovery_controller_min_samples",
+				   "10");
+    g_ceph_context->_conf->apply_changes(nullptr);
+  }
+
+  void TearDown() override {
+    g_ceph_context->_conf->set_val("osd_recovery_controller_target_latency",
+				   "0");
+    g_ceph_context->_conf->apply_changes(nullptr);
+  }
+
+  void add_samples(double lat, unsigned n = 100) {
+    utime_t t;
+    t.set_from_double(lat);
+    for (unsigned i = 0; i < n; ++i) {
+      rc.add_client_op_latency(t);
+    }
+  }
+};
+
+TEST_F(RecoveryControllerTest, disabled_uses_base)
+{
+  g_ceph_context->_conf->set_val("osd_recovery_controller_target_latency",
+				 "0");
+  g_ceph_context->_conf->apply_changes(nullptr);
+  rc.update(3, 0.1);
+  ASSERT_FALSE(rc.is_enabled());
+  ASSERT_EQ(3u, rc.get_max_active());
+  ASSERT_DOUBLE_EQ(0.1, rc.get_sleep());
+}
+
+TEST_F(RecoveryControllerTest, throttle_and_release)
+{
+  rc.update(4, 0);
+  ASSERT_TRUE(rc.is_enabled());
+  // no client load: concurrency grows to the ceiling
+  for (int i = 0; i < 10; ++i) {
+    rc.update(4, 0);
+  }
+  ASSERT_EQ(8u, rc.get_max_active());
+  ASSERT_DOUBLE_EQ(0, rc.get_sleep());
+
+  // clients over target: halve concurrency, start sleeping
+  add_samples(0.5);
+  rc.update(4, 0);
+  ASSERT_EQ(4u, rc.get_max_active());
+  ASSERT_GT(rc.get_sleep(), 0);
+  ASSERT_DOUBLE_EQ(0.5, rc.get_client_p99());
+
+  for (int i = 0; i < 20; ++i) {
+    add_samples(0.5);
+    rc.update(4, 0);
+  }
+  ASSERT_EQ(1u, rc.get_max_active());
+  ASSERT_DOUBLE_EQ(0.5, rc.get_sleep());
+
+  // clients well under target: sleep drains away before concurrency grows
+  add_samples(0.01);
+  rc.update(4, 0);
+  ASSERT_EQ(1u, rc.get_max_active());
+  ASSERT_DOUBLE_EQ(0.25, rc.get_sleep());
+  for (int i = 0; i < 20; ++i) {
+    add_samples(0.01);
+    rc.update(4, 0);
+  }
+  ASSERT_DOUBLE_EQ(0, rc.get_sleep());
+  ASSERT_GT(rc.get_max_active(), 1u);
+}
+
+TEST_F(RecoveryControllerTest, p99_ignores_outliers)
+{
+  rc.update(4, 0);
+  add_samples(0.01, 995);
+  add_samples(5.0, 5);
+  rc.update(4, 0);
+  ASSERT_DOUBLE_EQ(0.01, rc.get_client_p99());
+}
+
+TEST_F(RecoveryControllerTest, concurrent_samples)
+{
+  rc.update(4, 0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([this] { add_samples(0.5, 10000); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  rc.update(4, 0);
+  ASSERT_DOUBLE_EQ(0.5, rc.get_client_p99());
+  ASSERT_EQ(2u, rc.get_max_active());
+
+  // every sample was consumed by that update
+  rc.update(4, 0);
+  ASSERT_DOUBLE_EQ(0, rc.get_client_p99());
+}
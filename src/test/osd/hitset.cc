@@ -195,3 +195,77 @@ TEST_F(ExplicitObjectHitSetTest, RejectsNoMatch) {
   }
   EXPECT_EQ(matches, 0);
 }
+
+class CountMinHitSetTest : public testing::Test, public HitSetTestStrap {
+public:
+
+  CountMinHitSetTest() : HitSetTestStrap(new HitSet(new CountMinHitSet)) {}
+
+  void rebuild(uint64_t target, uint32_t depth, uint64_t seed) {
+    CountMinHitSet::Params *cparams =
+      new CountMinHitSet::Params(target, depth, seed);
+    HitSet::Params param(cparams);
+    HitSet new_set(param);
+    *hitset = new_set;
+  }
+
+  CountMinHitSet *get_hitset() { return static_cast<CountMinHitSet*>(hitset->impl.get()); }
+};
+
+TEST_F(CountMinHitSetTest, Construct) {
+  ASSERT_EQ(hitset->impl->get_type(), HitSet::TYPE_COUNT_MIN);
+  // success!
+}
+
+TEST_F(CountMinHitSetTest, InsertsMatch) {
+  rebuild(100, 4, 1);
+  fill(50);
+  verify_fill(50);
+  EXPECT_TRUE(hitset->approx_unique_insert_count() <= 50 &&
+              hitset->approx_unique_insert_count() >= 45);
+  EXPECT_FALSE(hitset->is_full());
+}
+
+TEST_F(CountMinHitSetTest, FillsUp) {
+  rebuild(20, 4, 1);
+  fill(20);
+  verify_fill(20);
+  EXPECT_TRUE(hitset->is_full());
+}
+
+TEST_F(CountMinHitSetTest, Counts) {
+  rebuild(100, 4, 1);
+  hobject_t hot(object_t("hot"), "", 0, 1234, 0, "");
+  hobject_t cold(object_t("cold"), "", 0, 5678, 0, "");
+  for (int i = 0; i < 10; ++i)
+    hitset->insert(hot);
+  hitset->insert(cold);
+  // never underestimates
+  EXPECT_GE(hitset->count(hot), 10u);
+  EXPECT_GE(hitset->count(cold), 1u);
+  EXPECT_GT(hitset->count(hot), hitset->count(cold));
+
+  // counters saturate rather than wrap
+  for (int i = 0; i < 300; ++i)
+    hitset->insert(hot);
+  EXPECT_EQ(255u, hitset->count(hot));
+}
+
+TEST_F(CountMinHitSetTest, EncodeDecode) {
+  rebuild(100, 4, 7);
+  fill(30);
+  hobject_t hot(object_t("hot"), "", 0, 1234, 0, "");
+  for (int i = 0; i < 5; ++i)
+    hitset->insert(hot);
+
+  bufferlist bl;
+  ::encode(*hitset, bl);
+  HitSet h2;
+  bufferlist::iterator p = bl.begin();
+  ::decode(h2, p);
+  EXPECT_EQ(HitSet::TYPE_COUNT_MIN, h2.impl->get_type());
+  EXPECT_EQ(hitset->insert_count(), h2.insert_count());
+  EXPECT_EQ(hitset->count(hot), h2.count(hot));
+  HitSetTestStrap s2(&h2);
+  s2.verify_fill(30);
+}
@@ -1025,6 +1025,98 @@ TEST(pg_missing_t, split_into)
   EXPECT_TRUE(missing.is_missing(oid2));
 }
 
+TEST(pg_log_t, split_out_child)
+{
+  pg_log_t log;
+  for (unsigned i = 1; i <= 8; ++i) {
+    pg_log_entry_t e;
+    e.op = pg_log_entry_t::MODIFY;
+    e.soid = hobject_t(object_t("obj" + stringify(i)), "", CEPH_NOSNAP,
+		       i, 0, "");
+    e.version = eversion_t(1, i);
+    log.log.push_back(e);
+  }
+  log.head = eversion_t(1, 8);
+  pg_t child_pgid;
+  child_pgid.m_seed = 1;
+  pg_log_t child = log.split_out_child(child_pgid, 1);
+  ASSERT_EQ(4u, child.log.size());
+  ASSERT_EQ(4u, log.log.size());
+  eversion_t last;
+  for (auto& e : child.log) {
+    EXPECT_EQ(1u, e.soid.get_hash() & 1);
+    EXPECT_LT(last, e.version);
+    last = e.version;
+  }
+  last = eversion_t();
+  for (auto& e : log.log) {
+    EXPECT_EQ(0u, e.soid.get_hash() & 1);
+    EXPECT_LT(last, e.version);
+    last = e.version;
+  }
+  EXPECT_EQ(log.head, child.head);
+}
+
+TEST(pg_log_entry_t, modified_extents)
+{
+  hobject_t oid(object_t("objname"), "key", CEPH_NOSNAP, 1, 0, "");
+  pg_log_entry_t e(pg_log_entry_t::MODIFY, oid, eversion_t(1, 2),
+		   eversion_t(1, 1), 2, osd_reqid_t(), utime_t(), 0);
+  {
+    bufferlist bl;
+    encode(e, bl);
+    pg_log_entry_t d;
+    auto p = bl.begin();
+    decode(d, p);
+    EXPECT_FALSE(d.extents_tracked());
+  }
+  interval_set<uint64_t> extents;
+  extents.insert(0, 4096);
+  extents.insert(65536, 100);
+  e.set_modified_extents(extents);
+  {
+    bufferlist bl;
+    encode(e, bl);
+    pg_log_entry_t d;
+    auto p = bl.begin();
+    decode(d, p);
+    EXPECT_TRUE(d.extents_tracked());
+    EXPECT_EQ(*e.modified_extents, *d.modified_extents);
+    EXPECT_EQ(2u, d.modified_extents->num_intervals());
+    EXPECT_EQ(4096u + 100u, d.modified_extents->size());
+    EXPECT_EQ(e.version, d.version);
+  }
+}
+
+TEST(ObjectRecoveryInfo, clean_subset_compat)
+{
+  ObjectRecoveryInfo info;
+  info.soid = hobject_t(object_t("objname"), "key", CEPH_NOSNAP, 1, 0, "");
+  info.size = 65536;
+  info.copy_subset.insert(0, 65536);
+  {
+    // without a clean_subset an older peer may decode us
+    bufferlist bl;
+    info.encode(bl, CEPH_FEATURES_SUPPORTED_DEFAULT);
+    EXPECT_EQ(3, bl[0]);
+    EXPECT_EQ(1, bl[1]);
+  }
+  info.copy_subset.clear();
+  info.copy_subset.insert(0, 4096);
+  info.clean_subset.insert(4096, 61440);
+  {
+    bufferlist bl;
+    info.encode(bl, CEPH_FEATURES_SUPPORTED_DEFAULT);
+    EXPECT_EQ(3, bl[0]);
+    EXPECT_EQ(3, bl[1]);
+    ObjectRecoveryInfo d;
+    auto p = bl.begin();
+    d.decode(p);
+    EXPECT_EQ(info.copy_subset, d.copy_subset);
+    EXPECT_EQ(info.clean_subset, d.clean_subset);
+  }
+}
+
 TEST(pg_pool_t_test, get_pg_num_divisor) {
   pg_pool_t p;
   p.set_pg_num(16);